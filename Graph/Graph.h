@@ -1,14 +1,13 @@
 #pragma once
 
 #include "Node.h"
+#include "../HashMap/Hashers.h"
 
 // Custom Hash for std::pair<T1, T2>
 struct pairHash {
     template <class T1, class T2>
     size_t operator()(const std::pair<T1, T2>& p) const noexcept {
-        size_t h1 = std::hash<T1>{}(p.first);
-        size_t h2 = std::hash<T2>{}(p.second);
-        return h1 ^ (h2 + 0x9e3779b9u + (h1 << 6) + (h1 >> 2));
+        return pSTL::hash_combine(std::hash<T1>{}(p.first), std::hash<T2>{}(p.second));
     }
 };
 
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <cstdint>
+
+#include "HashMap.h"
+
+
+namespace pSTL {
+    /*
+    * Shard choice shared by the sharded containers (ConcurrentHashMap,
+    * ShardedCache). The count is rounded up to a power of two, 4 per
+    * hardware thread when 0 is passed, and a hash maps to the top bits of
+    * its Fibonacci-mixed value. HashMap indexes by the low bits of its own
+    * mix, so the shard and the bucket inside it stay independent
+    */
+    class ShardSelector {
+    public:
+        explicit ShardSelector(size_t shardCount = 0) noexcept
+            : m_count(roundUpPow2(shardCount ? shardCount : defaultCount())), m_shift(64 - log2(m_count)) {
+        }
+
+        size_t count() const noexcept { return m_count; }
+
+        size_t operator()(size_t hash) const noexcept {
+            if (m_shift == 64)
+                return 0;
+            uint64_t h = static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+            return static_cast<size_t>(h >> m_shift);
+        }
+
+    private:
+        static size_t defaultCount() noexcept {
+            unsigned threads = std::thread::hardware_concurrency();
+            return 4 * static_cast<size_t>(threads ? threads : 1);
+        }
+
+        static size_t roundUpPow2(size_t n) noexcept {
+            size_t pow2 = 1;
+            while (pow2 < n) pow2 <<= 1;
+            return pow2;
+        }
+
+        static unsigned log2(size_t pow2) noexcept {
+            unsigned bits = 0;
+            while (pow2 > 1) { pow2 >>= 1; bits++; }
+            return bits;
+        }
+
+        size_t m_count;
+        unsigned m_shift;   // 64 - log2(m_count)
+    };
+
+    /*
+    * Thread-safe hash map made of independently locked HashMap shards.
+    *
+    * A key's shard is picked from the top bits of its mixed hash, so keys
+    * spread evenly while each shard's HashMap indexes by the low bits.
+    * Every shard has its own reader-writer lock, NodePool and bucket
+    * array on separate cache lines: readers of one shard never block each
+    * other, and writers only block the keys that share their shard.
+    *
+    * find returns a copy of the value, since a pointer into a shard could
+    * be invalidated by another thread as soon as the lock is released.
+    * Callbacks passed to insert_or_update run under the shard's exclusive
+    * lock and must not call back into the map. for_each copies one shard
+    * at a time under its shared lock and calls fn on the copy, so each
+    * shard is seen consistently but the map as a whole is not a single
+    * point-in-time snapshot. size() is exact only while no writer runs
+    */
+    template <typename key_t, typename value_t, typename Hash = std::hash<key_t>, typename KeyEqual = std::equal_to<key_t>>
+    class ConcurrentHashMap {
+    public:
+        using map_t = HashMap<key_t, value_t, Hash, KeyEqual>;
+        static constexpr size_t CacheLine = 64;
+
+
+        /********************** Constructors **********************/
+
+        // shardCount == 0 picks 4 shards per hardware thread; the count is
+        // rounded up to a power of two. capacity is the expected total
+        // number of entries, spread over the shards
+        explicit ConcurrentHashMap(size_t shardCount = 0, size_t capacity = 0)
+            : m_selector(shardCount), m_shards(new Shard[m_selector.count()]) {
+            if (capacity)
+                reserve(capacity);
+        }
+
+        ConcurrentHashMap(std::initializer_list<std::pair<key_t, value_t>> initList)
+            : ConcurrentHashMap(0, initList.size()) {
+            for (const auto& p : initList) {
+                insert(p.first, p.second);
+            }
+        }
+
+        ConcurrentHashMap(const ConcurrentHashMap&) = delete;
+        ConcurrentHashMap& operator=(const ConcurrentHashMap&) = delete;
+
+
+        /********************** Getters **********************/
+
+        std::optional<value_t> find(const key_t& key) const {
+            const Shard& shard = shardFor(key);
+            std::shared_lock<std::shared_mutex> lock(shard.lock);
+            const node_t* node = shard.map.find(key);
+            if (!node)
+                return std::nullopt;
+            return node->getValue();
+        }
+
+        value_t at(const key_t& key) const {
+            std::optional<value_t> value = find(key);
+            if (!value)
+                throw std::out_of_range("Key not found");
+            return std::move(*value);
+        }
+
+        bool contains(const key_t& key) const {
+            const Shard& shard = shardFor(key);
+            std::shared_lock<std::shared_mutex> lock(shard.lock);
+            return shard.map.contains(key);
+        }
+
+        size_t size() const {
+            size_t total = 0;
+            for (size_t i = 0; i < m_selector.count(); i++) {
+                std::shared_lock<std::shared_mutex> lock(m_shards[i].lock);
+                total += m_shards[i].map.size();
+            }
+            return total;
+        }
+
+        bool empty() const { return size() == 0; }
+
+        size_t shard_count() const { return m_selector.count(); }
+
+
+        /********************** Utility **********************/
+
+        // Inserts or overwrites; true if the key was new
+        bool insert(const key_t& key, const value_t& value) {
+            Shard& shard = shardFor(key);
+            std::unique_lock<std::shared_mutex> lock(shard.lock);
+            return shard.map.insert_or_assign(key, value).second;
+        }
+
+        // Inserts only if absent; true if the key was new
+        template <typename... Args>
+        bool try_emplace(const key_t& key, Args&&... args) {
+            Shard& shard = shardFor(key);
+            std::unique_lock<std::shared_mutex> lock(shard.lock);
+            return shard.map.try_emplace(key, std::forward<Args>(args)...).second;
+        }
+
+        // Atomic read-modify-write: value-initializes the entry if absent,
+        // then calls fn(value_t&) under the shard lock; true if the key was new
+        template <typename Fn>
+        bool insert_or_update(const key_t& key, Fn&& fn) {
+            Shard& shard = shardFor(key);
+            std::unique_lock<std::shared_mutex> lock(shard.lock);
+            auto result = shard.map.try_emplace(key);
+            fn(result.first->getValue());
+            return result.second;
+        }
+
+        bool erase(const key_t& key) {
+            Shard& shard = shardFor(key);
+            std::unique_lock<std::shared_mutex> lock(shard.lock);
+            return shard.map.erase(key);
+        }
+
+        // Calls fn(const key_t&, const value_t&) for every entry, working
+        // from a per-shard copy so fn runs without any lock held
+        template <typename Fn>
+        void for_each(Fn&& fn) const {
+            std::vector<std::pair<key_t, value_t>> snapshot;
+            for (size_t i = 0; i < m_selector.count(); i++) {
+                snapshot.clear();
+                {
+                    std::shared_lock<std::shared_mutex> lock(m_shards[i].lock);
+                    snapshot.reserve(m_shards[i].map.size());
+                    m_shards[i].map.for_each([&](const key_t& key, const value_t& value) {
+                        snapshot.emplace_back(key, value);
+                    });
+                }
+                for (const auto& entry : snapshot)
+                    fn(entry.first, entry.second);
+            }
+        }
+
+        // Makes room for capacity entries in total
+        void reserve(size_t capacity) {
+            size_t perShard = capacity / m_selector.count() + 1;
+            for (size_t i = 0; i < m_selector.count(); i++) {
+                std::unique_lock<std::shared_mutex> lock(m_shards[i].lock);
+                m_shards[i].map.reserve(perShard);
+            }
+        }
+
+        void clear() {
+            for (size_t i = 0; i < m_selector.count(); i++) {
+                std::unique_lock<std::shared_mutex> lock(m_shards[i].lock);
+                m_shards[i].map.clear();
+            }
+        }
+
+    private:
+        using node_t = typename map_t::node_t;
+
+        struct alignas(CacheLine) Shard {
+            mutable std::shared_mutex lock;
+            map_t map;
+        };
+
+        size_t shardIndex(const key_t& key) const {
+            return m_selector(m_hash(key));
+        }
+
+        Shard& shardFor(const key_t& key) {
+            return m_shards[shardIndex(key)];
+        }
+        const Shard& shardFor(const key_t& key) const {
+            return m_shards[shardIndex(key)];
+        }
+
+        ShardSelector m_selector;
+        Hash m_hash;
+        std::unique_ptr<Shard[]> m_shards;
+    };
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+
+namespace pSTL {
+    namespace epoch {
+        /*
+        * Epoch-based reclamation.
+        *
+        * A global epoch counter advances only when every thread inside a
+        * read-side section (a Guard) has announced the current epoch. An
+        * object unlinked while the epoch was e can therefore be freed once
+        * the epoch reaches e + 2: every reader that could still hold a
+        * pointer to it has left its section by then.
+        *
+        * Each thread owns one cache-line-sized record holding the epoch it
+        * entered at (0 when outside any section). Records are claimed on a
+        * thread's first Guard, returned when the thread exits and reused by
+        * later threads; they are never freed while the process runs
+        */
+        struct alignas(64) Record {
+            std::atomic<uint64_t> active{ 0 };  // epoch entered at, 0 = quiescent
+            std::atomic<bool> used{ false };
+            Record* next = nullptr;
+            unsigned nesting = 0;               // touched by the owning thread only
+        };
+
+        class Domain {
+        public:
+            Domain() = default;
+            Domain(const Domain&) = delete;
+            Domain& operator=(const Domain&) = delete;
+
+            ~Domain() {
+                Record* record = m_records.load(std::memory_order_acquire);
+                while (record) {
+                    Record* next = record->next;
+                    delete record;
+                    record = next;
+                }
+            }
+
+            uint64_t current() const noexcept {
+                return m_epoch.load(std::memory_order_acquire);
+            }
+
+            // Epoch to retire an object with, read after unlinking it. The
+            // read-modify-write puts any later advance in this release
+            // sequence, so a reader that sees the advanced epoch (even one
+            // made by another writer) also sees the unlink
+            uint64_t retire_epoch() noexcept {
+                return m_epoch.fetch_add(0, std::memory_order_acq_rel);
+            }
+
+            // A free record, reused if possible, else a new one pushed onto the list
+            Record* acquire() {
+                for (Record* record = m_records.load(std::memory_order_acquire); record; record = record->next) {
+                    bool expected = false;
+                    if (!record->used.load(std::memory_order_relaxed)
+                        && record->used.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+                        return record;
+                }
+
+                Record* record = new Record();
+                record->used.store(true, std::memory_order_relaxed);
+                Record* head = m_records.load(std::memory_order_relaxed);
+                do {
+                    record->next = head;
+                } while (!m_records.compare_exchange_weak(head, record, std::memory_order_release, std::memory_order_relaxed));
+                return record;
+            }
+
+            void release(Record* record) noexcept {
+                record->used.store(false, std::memory_order_release);
+            }
+
+            // Advances the epoch if no reader is still in an older one;
+            // returns the epoch afterwards
+            uint64_t try_advance() noexcept {
+                uint64_t epoch = m_epoch.load(std::memory_order_acquire);
+                // Pairs with the fence in Guard: either this scan sees the
+                // reader's announcement, or the reader sees every unlink made
+                // before this call
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                for (Record* record = m_records.load(std::memory_order_acquire); record; record = record->next) {
+                    uint64_t active = record->active.load(std::memory_order_acquire);
+                    if (active != 0 && active != epoch)
+                        return epoch;
+                }
+                m_epoch.compare_exchange_strong(epoch, epoch + 1, std::memory_order_acq_rel);
+                return m_epoch.load(std::memory_order_acquire);
+            }
+
+        private:
+            std::atomic<uint64_t> m_epoch{ 1 };
+            std::atomic<Record*> m_records{ nullptr };
+        };
+
+        inline Domain& global_domain() {
+            static Domain domain;
+            return domain;
+        }
+
+        // The calling thread's record, claimed on first use and released at thread exit
+        inline Record& thread_record() {
+            struct Owner {
+                Record* record = global_domain().acquire();
+                ~Owner() { global_domain().release(record); }
+            };
+            thread_local Owner owner;
+            return *owner.record;
+        }
+
+        // RAII read-side section; nests, only the outermost Guard announces
+        class Guard {
+        public:
+            Guard()
+                : m_record(thread_record()) {
+                if (m_record.nesting++ == 0) {
+                    // release: a writer that reads this also sees everything
+                    // the previous section of this thread read
+                    m_record.active.store(global_domain().current(), std::memory_order_release);
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                }
+            }
+
+            ~Guard() {
+                if (--m_record.nesting == 0)
+                    m_record.active.store(0, std::memory_order_release);
+            }
+
+            Guard(const Guard&) = delete;
+            Guard& operator=(const Guard&) = delete;
+
+        private:
+            Record& m_record;
+        };
+    }
+}
@@ -0,0 +1,383 @@
+#pragma once
+
+#include <stdexcept>
+#include <functional>
+#include <initializer_list>
+#include <utility>
+#include <new>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+
+
+namespace pSTL {
+    // One entry of a FlatHashMap; exposes the same accessors as Node so
+    // code written against HashMap::find works unchanged
+    template <typename key_t, typename value_t>
+    class FlatSlot {
+    public:
+        FlatSlot(const key_t& key, const value_t& value)
+            : m_key(key), m_val(value) {
+        }
+
+        const key_t& getKey() const {
+            return m_key;
+        }
+        value_t& getValue() {
+            return m_val;
+        }
+        const value_t& getValue() const {
+            return m_val;
+        }
+
+    private:
+        key_t m_key;
+        value_t m_val;
+    };
+
+    /*
+    * Open-addressing hash map with the same interface as HashMap.
+    *
+    * Entries live directly in one slot array, next to a parallel array of
+    * 16-bit probe distances (0 = empty, d = d-1 slots away from home).
+    * Collisions are resolved by linear probing with Robin Hood ordering:
+    * an insert displaces any entry that sits closer to its home than the
+    * new one would, which keeps probe lengths short and lets lookups stop
+    * at the first entry richer than the key being searched. Erase shifts
+    * the following cluster back by one, so there are no tombstones.
+    *
+    * The slot count is a power of two and the hash is spread with a
+    * Fibonacci multiply, so std::hash identity hashes of integers still
+    * land well. Growth is automatic at 7/8 load. Inserting or erasing
+    * invalidates pointers returned by find
+    */
+    template <typename key_t, typename value_t>
+    class FlatHashMap {
+    public:
+        using slot_t = FlatSlot<key_t, value_t>;
+
+
+        /********************** Constructors **********************/
+
+        // capacity: number of entries that fit before the first rehash
+        explicit FlatHashMap(size_t capacity = 10)
+            : FlatHashMap(SlotCount{ slotsFor(capacity) }) {
+        }
+
+        FlatHashMap(std::initializer_list<std::pair<key_t, value_t>> initList)
+            : FlatHashMap(initList.size()) {
+            for (const auto& p : initList) {
+                insert(p.first, p.second);
+            }
+        }
+
+        ~FlatHashMap() {
+            clear();
+            deallocate();
+        }
+
+        // Delegates, so a throwing copy is cleaned up by the destructor
+        FlatHashMap(const FlatHashMap& other)
+            : FlatHashMap(SlotCount{ other.m_capacity }) {
+            for (size_t i = 0; i < m_capacity; i++) {
+                if (other.m_dist[i]) {
+                    ::new (static_cast<void*>(m_slots + i)) slot_t(other.m_slots[i]);
+                    m_dist[i] = other.m_dist[i];
+                    m_size++;
+                }
+            }
+        }
+
+        FlatHashMap(FlatHashMap&& other) noexcept
+            : m_slots(other.m_slots), m_dist(other.m_dist), m_capacity(other.m_capacity), m_size(other.m_size), m_shift(other.m_shift) {
+            other.m_slots = nullptr;
+            other.m_dist = nullptr;
+            other.m_capacity = 0;
+            other.m_size = 0;
+        }
+
+        FlatHashMap& operator=(const FlatHashMap& other) {
+            if (this == &other)
+                return *this;
+
+            FlatHashMap temp = other;
+            swap(temp);
+            return *this;
+        }
+
+        FlatHashMap& operator=(FlatHashMap&& other) noexcept {
+            if (this == &other)
+                return *this;
+
+            clear();
+            deallocate();
+            swap(other);
+            return *this;
+        }
+
+
+        /********************** Getters **********************/
+
+        value_t& operator[](const key_t& key) {
+            slot_t* slot = find(key);
+            if (slot)
+                return slot->getValue();
+
+            size_t index = insertNew(key, value_t{}); // may rehash, read m_slots after
+            return m_slots[index].getValue();
+        }
+
+        value_t& at(const key_t& key) {
+            slot_t* slot = find(key);
+            if (!slot)
+                throw std::out_of_range("Key not found");
+            return slot->getValue();
+        }
+
+        size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+
+
+        /********************** Utility **********************/
+
+        void insert(const key_t& key, const value_t& value) {
+            slot_t* slot = find(key);
+            if (slot) {
+                slot->getValue() = value;
+                return;
+            }
+            insertNew(key, value);
+        }
+
+        bool erase(const key_t& key) {
+            size_t index = indexOf(key);
+            if (index == npos)
+                return false;
+
+            m_slots[index].~slot_t();
+            m_size--;
+
+            // Backward shift: pull the rest of the cluster one step closer home
+            size_t next = (index + 1) & mask();
+            while (m_dist[next] > 1) {
+                ::new (static_cast<void*>(m_slots + index)) slot_t(std::move(m_slots[next]));
+                m_slots[next].~slot_t();
+                m_dist[index] = static_cast<uint16_t>(m_dist[next] - 1);
+                index = next;
+                next = (next + 1) & mask();
+            }
+            m_dist[index] = 0;
+            return true;
+        }
+
+        // Makes room for newCapacity entries without further rehashing
+        void reserve(size_t newCapacity) {
+            size_t slots = slotsFor(newCapacity);
+            if (slots > m_capacity)
+                rehash(slots);
+        }
+
+        slot_t* find(const key_t& key) {
+            size_t index = indexOf(key);
+            return index == npos ? nullptr : m_slots + index;
+        }
+
+        void grow() {
+            rehash(m_capacity ? m_capacity * 2 : MinSlots);
+        }
+
+        void swap(FlatHashMap& other) noexcept {
+            std::swap(m_slots, other.m_slots);
+            std::swap(m_dist, other.m_dist);
+            std::swap(m_capacity, other.m_capacity);
+            std::swap(m_size, other.m_size);
+            std::swap(m_shift, other.m_shift);
+        }
+
+        void clear() {
+            for (size_t i = 0; i < m_capacity && m_size; i++) {
+                if (m_dist[i]) {
+                    m_slots[i].~slot_t();
+                    m_dist[i] = 0;
+                    m_size--;
+                }
+            }
+            m_size = 0;
+        }
+
+    private:
+        struct SlotCount { size_t slots; };
+
+        explicit FlatHashMap(SlotCount count)
+            : m_slots(nullptr), m_dist(nullptr), m_capacity(0), m_size(0), m_shift(0) {
+            if (count.slots)
+                allocate(count.slots);
+        }
+
+        static constexpr size_t npos = static_cast<size_t>(-1);
+        static constexpr size_t MinSlots = 8;
+        static constexpr uint16_t MaxDistance = 0xFFFF;
+
+        size_t mask() const noexcept { return m_capacity - 1; }
+
+        // Slot count (power of two) keeping count entries under 7/8 load
+        static size_t slotsFor(size_t count) noexcept {
+            size_t needed = count + count / 7 + 1;
+            size_t slots = MinSlots;
+            while (slots < needed) slots <<= 1;
+            return slots;
+        }
+
+        size_t home(const key_t& key) const noexcept {
+            uint64_t h = static_cast<uint64_t>(std::hash<key_t>{}(key));
+            return static_cast<size_t>((h * 0x9E3779B97F4A7C15ull) >> m_shift);
+        }
+
+        size_t indexOf(const key_t& key) const {
+            if (m_capacity == 0)
+                return npos; // moved-from
+
+            size_t index = home(key);
+            uint16_t dist = 1;
+            while (m_dist[index] >= dist) {
+                if (m_dist[index] == dist && m_slots[index].getKey() == key)
+                    return index;
+                index = (index + 1) & mask();
+                dist++;
+            }
+            return npos;
+        }
+
+        // Inserts a key known to be absent; returns where it ended up
+        size_t insertNew(const key_t& key, const value_t& value) {
+            if (m_size + 1 > m_capacity - m_capacity / 8)
+                grow();
+
+            size_t index = placeRobinHood(slot_t(key, value), home(key));
+            m_size++;
+            return index;
+        }
+
+        // Walks the probe placeRobinHood would take from index without
+        // moving anything; false if some carried entry would exceed MaxDistance
+        bool probeFits(size_t index) const noexcept {
+            uint16_t dist = 1;
+            while (m_dist[index] != 0) {
+                if (m_dist[index] < dist)
+                    dist = m_dist[index];
+                if (dist == MaxDistance)
+                    return false;
+                index = (index + 1) & mask();
+                dist++;
+            }
+            return true;
+        }
+
+        // Robin Hood placement starting at home; returns the slot the entry
+        // passed in landed in (displaced entries are carried further on).
+        // Checked before the first swap, so a throw leaves the table as it was
+        size_t placeRobinHood(slot_t&& entry, size_t index) {
+            if (!probeFits(index))
+                throw std::length_error("FlatHashMap: probe sequence too long, the hash function is degenerate");
+            return placeUnchecked(std::move(entry), index);
+        }
+
+        // placeRobinHood for a probe already known to fit
+        size_t placeUnchecked(slot_t&& entry, size_t index) {
+            slot_t carry(std::move(entry));
+            uint16_t dist = 1;
+            size_t placed = npos;
+
+            while (true) {
+                if (m_dist[index] == 0) {
+                    ::new (static_cast<void*>(m_slots + index)) slot_t(std::move(carry));
+                    m_dist[index] = dist;
+                    return placed == npos ? index : placed;
+                }
+                if (m_dist[index] < dist) {
+                    std::swap(carry, m_slots[index]);
+                    std::swap(dist, m_dist[index]);
+                    if (placed == npos) placed = index;
+                }
+                index = (index + 1) & mask();
+                dist++;
+            }
+        }
+
+        // Places only the distances of source's entries, exactly as
+        // placeRobinHood would (its choices depend on distances alone), and
+        // zeroes them again; false if some entry would exceed MaxDistance
+        bool distancesFit(const FlatHashMap& source) {
+            bool fits = true;
+            for (size_t i = 0; i < source.m_capacity; i++) {
+                if (!source.m_dist[i])
+                    continue;
+                size_t index = home(source.m_slots[i].getKey());
+                if (!probeFits(index)) {
+                    fits = false;
+                    break;
+                }
+
+                uint16_t dist = 1;
+                while (m_dist[index] != 0) {
+                    if (m_dist[index] < dist)
+                        std::swap(dist, m_dist[index]);
+                    index = (index + 1) & mask();
+                    dist++;
+                }
+                m_dist[index] = dist;
+            }
+            std::memset(m_dist, 0, m_capacity * sizeof(uint16_t));
+            return fits;
+        }
+
+        // Builds the new table on the side and swaps it in at the end, so a
+        // throw (allocation, a throwing copy, a probe over MaxDistance)
+        // leaves the map as it was. Entries whose move may throw are copied
+        void rehash(size_t newCapacity) {
+            FlatHashMap fresh(SlotCount{ newCapacity });
+            if (!fresh.distancesFit(*this))
+                throw std::length_error("FlatHashMap: probe sequence too long, the hash function is degenerate");
+
+            for (size_t i = 0; i < m_capacity; i++) {
+                if (m_dist[i]) {
+                    fresh.placeUnchecked(slot_t(std::move_if_noexcept(m_slots[i])), fresh.home(m_slots[i].getKey()));
+                    fresh.m_size++;
+                }
+            }
+            swap(fresh);    // fresh destroys the old, moved-from entries
+        }
+
+        void allocate(size_t slots) {
+            slot_t* newSlots = static_cast<slot_t*>(::operator new(slots * sizeof(slot_t), std::align_val_t(alignof(slot_t))));
+            uint16_t* newDist;
+            try {
+                newDist = new uint16_t[slots]();
+            }
+            catch (...) {
+                ::operator delete(newSlots, std::align_val_t(alignof(slot_t)));
+                throw;
+            }
+            m_slots = newSlots;
+            m_dist = newDist;
+            m_capacity = slots;
+
+            m_shift = 64;
+            for (size_t s = slots; s > 1; s >>= 1) m_shift--;
+        }
+
+        void deallocate() noexcept {
+            ::operator delete(m_slots, std::align_val_t(alignof(slot_t)));
+            delete[] m_dist;
+            m_slots = nullptr;
+            m_dist = nullptr;
+            m_capacity = 0;
+        }
+
+        slot_t* m_slots;    // uninitialized storage; slot i is live iff m_dist[i] != 0
+        uint16_t* m_dist;
+        size_t m_capacity;  // number of slots, a power of two
+        size_t m_size;
+        unsigned m_shift;   // 64 - log2(m_capacity)
+    };
+}
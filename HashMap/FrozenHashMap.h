@@ -0,0 +1,298 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "Hashers.h"
+#include "Snapshot.h"
+
+
+namespace pSTL {
+    /*
+    * Read-only hash map served straight from an image written by
+    * HashMap::save.
+    *
+    * open() maps the file and checks its header and the two ends of the
+    * offset table, and nothing else: no entry is read or copied, so
+    * opening takes the same time whatever the size, and pages are faulted
+    * in by the lookups that touch them. Interior offsets are trusted
+    * rather than scanned; find clamps them to the entry array, so a
+    * corrupt one gives wrong answers but never reads past the mapping. The
+    * mapping is shared, so every process opening the same image uses one
+    * copy in the page cache.
+    *
+    * Hash and KeyEqual must match the map that wrote the image; the
+    * header stores the key/value sizes and the hashes of the first and
+    * last entries, so a different type or hasher is rejected on open. Failures throw
+    * std::runtime_error. find returns a pointer into the mapping, valid
+    * until the map is closed
+    */
+    template <typename key_t, typename value_t, typename Hash = std::hash<key_t>, typename KeyEqual = std::equal_to<key_t>>
+    class FrozenHashMap {
+        static_assert(std::is_trivially_copyable<key_t>::value && std::is_trivially_copyable<value_t>::value,
+            "FrozenHashMap: key and value types must be trivially copyable");
+
+    public:
+        using entry_t = snapshot::Entry<key_t, value_t>;
+        using const_iterator = const entry_t*;
+        using hasher = Hash;
+        using key_equal = KeyEqual;
+
+
+        /********************** Constructors **********************/
+
+        FrozenHashMap() noexcept
+            : m_base(nullptr), m_mappedBytes(0), m_file(invalidFile()),
+              m_offsets(EmptyOffsets), m_entries(nullptr), m_size(0), m_mask(0) {
+        }
+
+        explicit FrozenHashMap(const std::string& path, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual())
+            : FrozenHashMap() {
+            m_hash = hash;
+            m_equal = equal;
+            open(path);
+        }
+
+        FrozenHashMap(const FrozenHashMap&) = delete;
+        FrozenHashMap& operator=(const FrozenHashMap&) = delete;
+
+        FrozenHashMap(FrozenHashMap&& other) noexcept
+            : FrozenHashMap() {
+            swap(other);
+        }
+
+        FrozenHashMap& operator=(FrozenHashMap&& other) noexcept {
+            if (this != &other) {
+                close();
+                swap(other);
+            }
+            return *this;
+        }
+
+        ~FrozenHashMap() {
+            close();
+        }
+
+
+        /********************** File **********************/
+
+        void open(const std::string& path) {
+            close();
+
+            m_file = openFile(path);
+            try {
+                uint64_t fileBytes = fileSize();
+                if (fileBytes < snapshot::HeaderSize) throw std::runtime_error("FrozenHashMap: file too small for header");
+                map(static_cast<size_t>(fileBytes));
+
+                const snapshot::Header* h = reinterpret_cast<const snapshot::Header*>(m_base);
+                if (std::memcmp(h->magic, snapshot::Magic, sizeof(h->magic)) != 0) throw std::runtime_error("FrozenHashMap: bad file magic");
+                if (h->version != snapshot::Version) throw std::runtime_error("FrozenHashMap: unsupported version");
+                if (h->byteOrder != snapshot::ByteOrderMark) throw std::runtime_error("FrozenHashMap: byte order mismatch");
+                if (h->keySize != sizeof(key_t) || h->valueSize != sizeof(value_t)
+                    || h->entrySize != sizeof(entry_t) || h->entryAlign != alignof(entry_t))
+                    throw std::runtime_error("FrozenHashMap: key/value type mismatch");
+
+                uint64_t buckets = h->bucketCount;
+                uint64_t offsetsAt = snapshot::offsetsOffset<key_t, value_t>(h->count);
+                if (h->entriesOffset != snapshot::entriesOffset<key_t, value_t>()
+                    || h->count > fileBytes / sizeof(entry_t) || offsetsAt > fileBytes
+                    || buckets == 0 || (buckets & (buckets - 1)) != 0 || buckets + 1 > (fileBytes - offsetsAt) / sizeof(uint64_t))
+                    throw std::runtime_error("FrozenHashMap: file truncated or corrupt");
+
+                const uint64_t* offsets = reinterpret_cast<const uint64_t*>(m_base + offsetsAt);
+                if (offsets[0] != 0 || offsets[buckets] != h->count) throw std::runtime_error("FrozenHashMap: file truncated or corrupt");
+
+                m_offsets = offsets;
+                m_entries = reinterpret_cast<const entry_t*>(m_base + h->entriesOffset);
+                m_size = static_cast<size_t>(h->count);
+                m_mask = static_cast<size_t>(buckets - 1);
+                if (m_size && snapshot::hashCheck(hashOf(m_entries[0].key), hashOf(m_entries[m_size - 1].key)) != h->hashCheck)
+                    throw std::runtime_error("FrozenHashMap: hash function mismatch");
+            }
+            catch (...) {
+                close();
+                throw;
+            }
+        }
+
+        void close() noexcept {
+            if (m_base) unmap();
+            if (m_file != invalidFile()) closeFile();
+            m_offsets = EmptyOffsets;
+            m_entries = nullptr;
+            m_size = 0;
+            m_mask = 0;
+        }
+
+        bool is_open() const noexcept { return m_base != nullptr; }
+
+
+        /********************** Getters **********************/
+
+        const entry_t* find(const key_t& key) const {
+            size_t bucket = hashOf(key) & m_mask;
+            // Clamped: interior offsets are not validated on open
+            const entry_t* last = m_entries + std::min<uint64_t>(m_offsets[bucket + 1], m_size);
+            for (const entry_t* curr = m_entries + m_offsets[bucket]; curr < last; ++curr) {
+                if (m_equal(curr->key, key))
+                    return curr;
+            }
+            return nullptr;
+        }
+
+        const value_t& at(const key_t& key) const {
+            const entry_t* entry = find(key);
+            if (!entry)
+                throw std::out_of_range("Key not found");
+            return entry->value;
+        }
+
+        bool contains(const key_t& key) const {
+            return find(key) != nullptr;
+        }
+
+        size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+        size_t bucket_count() const { return m_mask + 1; }
+
+        hasher hash_function() const { return m_hash; }
+        key_equal key_eq() const { return m_equal; }
+
+
+        /********************** Iterators **********************/
+
+        // Entries in bucket order
+        const_iterator begin() const { return m_entries; }
+        const_iterator end() const { return m_entries + m_size; }
+
+
+        /********************** Utility **********************/
+
+        void swap(FrozenHashMap& other) noexcept {
+            std::swap(m_base, other.m_base);
+            std::swap(m_mappedBytes, other.m_mappedBytes);
+            std::swap(m_file, other.m_file);
+            std::swap(m_offsets, other.m_offsets);
+            std::swap(m_entries, other.m_entries);
+            std::swap(m_size, other.m_size);
+            std::swap(m_mask, other.m_mask);
+            std::swap(m_hash, other.m_hash);
+            std::swap(m_equal, other.m_equal);
+        }
+
+    private:
+        // Offsets of a closed map: one empty bucket
+        static constexpr uint64_t EmptyOffsets[2] = { 0, 0 };
+
+        // The finish HashMap used to pick the buckets
+        size_t hashOf(const key_t& key) const {
+            return hash_detail::finish<Hash>(m_hash(key));
+        }
+
+
+        /********************** Platform **********************/
+
+#if defined(_WIN32)
+        using file_t = HANDLE;
+        static file_t invalidFile() noexcept { return INVALID_HANDLE_VALUE; }
+
+        static file_t openFile(const std::string& path) {
+            HANDLE file = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("FrozenHashMap: cannot open " + path);
+            return file;
+        }
+
+        void closeFile() noexcept {
+            ::CloseHandle(m_file);
+            m_file = invalidFile();
+        }
+
+        uint64_t fileSize() const {
+            LARGE_INTEGER size;
+            if (!::GetFileSizeEx(m_file, &size)) throw std::runtime_error("FrozenHashMap: cannot stat file");
+            return static_cast<uint64_t>(size.QuadPart);
+        }
+
+        void map(size_t bytes) {
+            HANDLE mapping = ::CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!mapping) throw std::runtime_error("FrozenHashMap: cannot map file");
+            void* view = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, bytes);
+            ::CloseHandle(mapping); // the view keeps the mapping object alive
+            if (!view) throw std::runtime_error("FrozenHashMap: cannot map file");
+
+            m_base = static_cast<const char*>(view);
+            m_mappedBytes = bytes;
+        }
+
+        void unmap() noexcept {
+            ::UnmapViewOfFile(m_base);
+            m_base = nullptr;
+            m_mappedBytes = 0;
+        }
+#else
+        using file_t = int;
+        static file_t invalidFile() noexcept { return -1; }
+
+        static file_t openFile(const std::string& path) {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) throw std::runtime_error("FrozenHashMap: cannot open " + path);
+            return fd;
+        }
+
+        void closeFile() noexcept {
+            ::close(m_file);
+            m_file = invalidFile();
+        }
+
+        uint64_t fileSize() const {
+            struct stat st;
+            if (::fstat(m_file, &st) != 0) throw std::runtime_error("FrozenHashMap: cannot stat file");
+            return static_cast<uint64_t>(st.st_size);
+        }
+
+        void map(size_t bytes) {
+            void* view = ::mmap(nullptr, bytes, PROT_READ, MAP_SHARED, m_file, 0);
+            if (view == MAP_FAILED) throw std::runtime_error("FrozenHashMap: cannot map file");
+
+            m_base = static_cast<const char*>(view);
+            m_mappedBytes = bytes;
+        }
+
+        void unmap() noexcept {
+            ::munmap(const_cast<char*>(m_base), m_mappedBytes);
+            m_base = nullptr;
+            m_mappedBytes = 0;
+        }
+#endif
+
+        const char* m_base;
+        size_t m_mappedBytes;
+        file_t m_file;
+        const uint64_t* m_offsets;  // bucket_count() + 1 entries into m_entries
+        const entry_t* m_entries;
+        size_t m_size;
+        size_t m_mask;              // bucket_count() - 1
+        Hash m_hash;
+        KeyEqual m_equal;
+    };
+}
@@ -6,27 +6,91 @@
 #include <initializer_list>
 #include <algorithm>
 #include <utility>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <memory>
+#include <type_traits>
+#include <tuple>
+#include <iterator>
+#include <thread>
+#include <exception>
+#include <string>
+#include <cstring>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+#include "NodePool.h"
+#include "Hashers.h"
+#include "Snapshot.h"
 
 
 namespace pSTL {
-    template <typename key_t, typename value_t>
-    class Node {
+    // Whether HashMap nodes for key K store the key's full hash. On by
+    // default for everything but scalars, whose hash is cheaper to recompute
+    // than the 8 bytes per node; specialize to override
+    template <typename K>
+    struct cache_hash_code : std::bool_constant<!std::is_scalar<K>::value> {};
+
+    template <bool Cache>
+    class NodeHashCode {
+    public:
+        void setHash(size_t) {}
+    };
+
+    template <>
+    class NodeHashCode<true> {
     public:
+        size_t getHash() const {
+            return m_hashCode;
+        }
+        void setHash(size_t hash) {
+            m_hashCode = hash;
+        }
+
+    private:
+        size_t m_hashCode = 0;
+    };
+
+    // Key and value are stored as one std::pair, which is what HashMap
+    // iterators point at
+    template <typename key_t, typename value_t, bool CacheHash = cache_hash_code<key_t>::value>
+    class Node : public NodeHashCode<CacheHash> {
+    public:
+        using entry_t = std::pair<const key_t, value_t>;
+
         Node(const key_t& key, const value_t& value)
-            : m_key(key), m_val(value), m_next(nullptr) {
+            : m_entry(key, value), m_next(nullptr) {
         }
         Node(const key_t& key, const value_t& value, Node* next)
-            : m_key(key), m_val(value), m_next(next) {
+            : m_entry(key, value), m_next(next) {
+        }
+        // Key from key, value from args, both constructed in place
+        template <typename K, typename... Args>
+        Node(std::piecewise_construct_t, K&& key, Args&&... args)
+            : m_entry(std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)), std::forward_as_tuple(std::forward<Args>(args)...)),
+              m_next(nullptr) {
         }
 
         const key_t& getKey() const {
-            return m_key;
+            return m_entry.first;
         }
         value_t& getValue() {
-            return m_val;
+            return m_entry.second;
         }
         const value_t& getValue() const {
-            return m_val;
+            return m_entry.second;
+        }
+        entry_t& getEntry() {
+            return m_entry;
+        }
+        const entry_t& getEntry() const {
+            return m_entry;
         }
         Node* getNext() const {
             return m_next;
@@ -40,22 +104,301 @@ namespace pSTL {
         }
 
     private:
-        key_t m_key;
-        value_t m_val;
+        entry_t m_entry;
         Node* m_next;
     };
 
-    template <typename key_t, typename value_t>
+    // Asks for the cache line holding p to be loaded; a hint only, so null
+    // or stale pointers are fine
+    inline void prefetchRead(const void* p) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(p, 0, 3);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#else
+        (void)p;
+#endif
+    }
+
+    /*
+    * Bucket head array plus an occupancy bitmap (bit i set iff bucket i is
+    * non-empty), so traversals jump between non-empty buckets with a
+    * count-trailing-zeros per 64 buckets. Heads are only changed through
+    * set/push, which keep the bitmap in step.
+    *
+    * Memory comes from calloc, which for large tables maps fresh zero pages
+    * instead of writing them, so allocating the next table costs no
+    * up-front O(n) fill; pages are faulted in as buckets are first used
+    */
+    template <typename node_t>
+    class BucketArray {
+    public:
+        BucketArray() noexcept
+            : m_heads(nullptr), m_bits(nullptr), m_size(0) {
+        }
+        explicit BucketArray(size_t size)
+            : BucketArray() {
+            assign(size);
+        }
+
+        BucketArray(const BucketArray&) = delete;
+        BucketArray& operator=(const BucketArray&) = delete;
+
+        BucketArray(BucketArray&& other) noexcept
+            : m_heads(other.m_heads), m_bits(other.m_bits), m_size(other.m_size) {
+            other.m_heads = nullptr;
+            other.m_bits = nullptr;
+            other.m_size = 0;
+        }
+        BucketArray& operator=(BucketArray&& other) noexcept {
+            BucketArray temp(std::move(other));
+            swap(temp);
+            return *this;
+        }
+
+        ~BucketArray() {
+            std::free(m_heads);
+            std::free(m_bits);
+        }
+
+        // size null heads; previous contents are dropped
+        void assign(size_t size) {
+            node_t** heads = nullptr;
+            uint64_t* bits = nullptr;
+            if (size) {
+                heads = static_cast<node_t**>(std::calloc(size, sizeof(node_t*)));
+                bits = static_cast<uint64_t*>(std::calloc(wordsFor(size), sizeof(uint64_t)));
+                if (!heads || !bits) {
+                    std::free(heads);
+                    std::free(bits);
+                    throw std::bad_alloc();
+                }
+            }
+            std::free(m_heads);
+            std::free(m_bits);
+            m_heads = heads;
+            m_bits = bits;
+            m_size = size;
+        }
+
+        void reset() noexcept {
+            std::free(m_heads);
+            std::free(m_bits);
+            m_heads = nullptr;
+            m_bits = nullptr;
+            m_size = 0;
+        }
+
+        node_t* operator[](size_t index) const { return m_heads[index]; }
+
+        void prefetch(size_t index) const noexcept { prefetchRead(m_heads + index); }
+
+        void set(size_t index, node_t* head) noexcept {
+            m_heads[index] = head;
+            if (head)
+                m_bits[index >> 6] |= bit(index);
+            else
+                m_bits[index >> 6] &= ~bit(index);
+        }
+
+        // Links node in front of bucket index
+        void push(size_t index, node_t* node) noexcept {
+            node->setNext(m_heads[index]);
+            m_heads[index] = node;
+            m_bits[index >> 6] |= bit(index);
+        }
+
+        // First non-empty bucket at or after from, size() if none
+        size_t next_occupied(size_t from) const noexcept {
+            if (from >= m_size)
+                return m_size;
+
+            size_t word = from >> 6;
+            uint64_t bits = m_bits[word] & (~0ull << (from & 63));
+            while (!bits) {
+                if (++word == wordsFor(m_size))
+                    return m_size;
+                bits = m_bits[word];
+            }
+            return (word << 6) | countTrailingZeros(bits);
+        }
+
+        // Nulls every head; touches only the occupied ones
+        void clear() noexcept {
+            for (size_t i = next_occupied(0); i < m_size; i = next_occupied(i + 1))
+                m_heads[i] = nullptr;
+            if (m_bits)
+                std::fill(m_bits, m_bits + wordsFor(m_size), 0);
+        }
+
+        size_t size() const noexcept { return m_size; }
+
+        void swap(BucketArray& other) noexcept {
+            std::swap(m_heads, other.m_heads);
+            std::swap(m_bits, other.m_bits);
+            std::swap(m_size, other.m_size);
+        }
+
+    private:
+        static size_t wordsFor(size_t size) noexcept { return (size + 63) >> 6; }
+        static uint64_t bit(size_t index) noexcept { return 1ull << (index & 63); }
+
+        static unsigned countTrailingZeros(uint64_t x) noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+            unsigned long index;
+#if defined(_WIN64)
+            _BitScanForward64(&index, x);
+#else
+            if (static_cast<uint32_t>(x)) {
+                _BitScanForward(&index, static_cast<unsigned long>(x));
+            }
+            else {
+                _BitScanForward(&index, static_cast<unsigned long>(x >> 32));
+                index += 32;
+            }
+#endif
+            return index;
+#else
+            return static_cast<unsigned>(__builtin_ctzll(x));
+#endif
+        }
+
+        node_t** m_heads;
+        uint64_t* m_bits;
+        size_t m_size;
+    };
+
+    /*
+    * Hash and KeyEqual both declaring is_transparent enables lookup by any
+    * key type they accept (find/at/erase/emplace with a string_view on a
+    * std::string map, ...) without building a key_t first.
+    *
+    * With rehash_step(n) > 0, growth triggered by an insert is incremental:
+    * the old bucket array is kept next to the new one and every following
+    * insert/find/at/erase moves n more old buckets over. Until the move is
+    * complete lookups check both arrays.
+    *
+    * Iterators are forward iterators over std::pair<const key_t, value_t>,
+    * so range-for with structured bindings works. Inserting or erasing
+    * invalidates them, and so does any lookup while rehashing() is true
+    */
+    template <typename key_t, typename value_t, typename Hash = std::hash<key_t>, typename KeyEqual = std::equal_to<key_t>>
     class HashMap {
+        template <typename F, typename = void>
+        struct is_transparent : std::false_type {};
+        template <typename F>
+        struct is_transparent<F, std::void_t<typename F::is_transparent>> : std::true_type {};
+
+        template <typename H, typename E>
+        static constexpr bool transparent_v = is_transparent<H>::value && is_transparent<E>::value;
+
     public:
-        using node_t = Node<key_t, value_t>;
+        using node_t = Node<key_t, value_t, cache_hash_code<key_t>::value>;
+        using pool_t = NodePool<node_t>;
+        using hasher = Hash;
+        using key_equal = KeyEqual;
+        using value_type = typename node_t::entry_t;
+
+    private:
+        template <bool Const>
+        class Iter {
+            using owner_t = std::conditional_t<Const, const HashMap, HashMap>;
+            using node_ptr = std::conditional_t<Const, const node_t*, node_t*>;
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = typename node_t::entry_t;
+            using difference_type = std::ptrdiff_t;
+            using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+            using reference = std::conditional_t<Const, const value_type&, value_type&>;
+
+            Iter() noexcept
+                : m_owner(nullptr), m_node(nullptr), m_bucket(0), m_inOld(false) {
+            }
+            // iterator -> const_iterator
+            template <bool C = Const, typename = std::enable_if_t<C>>
+            Iter(const Iter<false>& other) noexcept
+                : m_owner(other.m_owner), m_node(other.m_node), m_bucket(other.m_bucket), m_inOld(other.m_inOld) {
+            }
+
+            reference operator*() const { return m_node->getEntry(); }
+            pointer operator->() const { return &m_node->getEntry(); }
+
+            Iter& operator++() {
+                m_node = m_node->getNext();
+                if (!m_node)
+                    seek(m_bucket + 1);
+                return *this;
+            }
+            Iter operator++(int) {
+                Iter temp = *this;
+                ++*this;
+                return temp;
+            }
+
+            friend bool operator==(const Iter& a, const Iter& b) noexcept { return a.m_node == b.m_node; }
+            friend bool operator!=(const Iter& a, const Iter& b) noexcept { return a.m_node != b.m_node; }
+
+        private:
+            friend class HashMap;
+            friend class Iter<true>;
+
+            Iter(owner_t* owner, size_t bucket)
+                : m_owner(owner), m_node(nullptr), m_bucket(0), m_inOld(false) {
+                seek(bucket);
+            }
+
+            // First entry of the first non-empty bucket from bucket on: the
+            // current table, then whatever the old one still holds
+            void seek(size_t bucket) {
+                if (!m_inOld) {
+                    bucket = m_owner->m_map.next_occupied(bucket);
+                    if (bucket < m_owner->m_map.size()) {
+                        m_bucket = bucket;
+                        m_node = m_owner->m_map[bucket];
+                        return;
+                    }
+                    m_inOld = true;
+                    bucket = 0;
+                }
+                bucket = m_owner->m_oldMap.next_occupied(bucket);
+                if (bucket < m_owner->m_oldMap.size()) {
+                    m_bucket = bucket;
+                    m_node = m_owner->m_oldMap[bucket];
+                    return;
+                }
+                m_node = nullptr;
+            }
+
+            owner_t* m_owner;
+            node_ptr m_node;
+            size_t m_bucket;
+            bool m_inOld;
+        };
+
+    public:
+        using iterator = Iter<false>;
+        using const_iterator = Iter<true>;
 
 
         /********************** Constructors **********************/
 
+        // capacity is rounded up to a power of two
         explicit HashMap(size_t capacity = 10) 
-            : m_capacity(capacity ? capacity : 1), m_size(0) {
-            m_map.resize(m_capacity, nullptr);
+            : HashMap(capacity, nullptr) {
+        }
+
+        // Allocates nodes from pool, which other maps may share (one thread
+        // at a time). A null pool gives the map a private one
+        HashMap(size_t capacity, std::shared_ptr<pool_t> pool)
+            : HashMap(capacity, Hash(), KeyEqual(), std::move(pool)) {
+        }
+
+        // Stateful (seeded, counting, ...) hasher and equality instances
+        HashMap(size_t capacity, const Hash& hash, const KeyEqual& equal = KeyEqual(), std::shared_ptr<pool_t> pool = nullptr)
+            : m_capacity(roundUpPow2(capacity)), m_size(0), m_maxLoad(1.0f), m_hash(hash), m_equal(equal),
+              m_pool(pool ? std::move(pool) : std::make_shared<pool_t>()), m_map(m_capacity),
+              m_rehashStep(0), m_migrated(0) {
         }
 
         HashMap(std::initializer_list<std::pair<key_t, value_t>> initList)
@@ -70,49 +413,36 @@ namespace pSTL {
         }
 
         HashMap(const HashMap& other)
-            : m_capacity(other.m_capacity), m_size(other.m_size), m_map(other.m_capacity, nullptr) {
-            for (size_t i = 0; i < m_capacity; i++) {
-                node_t* currOther = other.m_map[i];
-                node_t** currThis = &m_map[i]; // pointer to the bucket in the new map
-                while (currOther) {
-                    *currThis = new node_t(currOther->getKey(), currOther->getValue());
-                    currOther = currOther->getNext();
-                    currThis = &((*currThis)->nextRef());
-                }
-            }
+            : m_capacity(other.m_capacity), m_size(other.m_size), m_maxLoad(other.m_maxLoad),
+              m_hash(other.m_hash), m_equal(other.m_equal), m_pool(std::make_shared<pool_t>()), m_map(other.m_capacity),
+              m_rehashStep(other.m_rehashStep), m_migrated(0) {
+            copyNodes(other);
         }
 
         HashMap(HashMap&& other) noexcept
-            : m_capacity(other.m_capacity), m_size(other.m_size), m_map(std::move(other.m_map)) {
+            : m_capacity(other.m_capacity), m_size(other.m_size), m_maxLoad(other.m_maxLoad),
+              m_hash(std::move(other.m_hash)), m_equal(std::move(other.m_equal)), m_pool(std::move(other.m_pool)), m_map(std::move(other.m_map)),
+              m_oldMap(std::move(other.m_oldMap)), m_rehashStep(other.m_rehashStep), m_migrated(other.m_migrated) {
             other.m_capacity = 0;
             other.m_size = 0;
+            other.m_migrated = 0;
         }
 
         HashMap& operator=(const HashMap& other) {
             if (this == &other)
                 return *this;
 
-            for (auto head : m_map) {
-                while (head) {
-                    node_t* temp = head;
-                    head = head->getNext();
-                    delete temp;
-                }
-            }
+            destroyNodes();
 
             m_capacity = other.m_capacity;
             m_size = other.m_size;
-            m_map.assign(m_capacity, nullptr);
-
-            for (size_t i = 0; i < m_capacity; ++i) {
-                node_t* currOther = other.m_map[i];
-                node_t** currThis = &m_map[i];
-                while (currOther) {
-                    *currThis = new node_t(currOther->getKey(), currOther->getValue());
-                    currOther = currOther->getNext();
-                    currThis = &((*currThis)->nextRef());
-                }
-            }
+            m_maxLoad = other.m_maxLoad;
+            m_hash = other.m_hash;
+            m_equal = other.m_equal;
+            m_rehashStep = other.m_rehashStep;
+            m_map.assign(m_capacity);
+
+            copyNodes(other);
             return *this;
         }
 
@@ -120,20 +450,22 @@ namespace pSTL {
             if (this == &other)
                 return *this;
 
-            for (auto head : m_map) {
-                while (head) {
-                    node_t* temp = head;
-                    head = head->getNext();
-                    delete temp;
-                }
-            }
+            destroyNodes();
 
             m_capacity = other.m_capacity;
             m_size = other.m_size;
+            m_maxLoad = other.m_maxLoad;
+            m_hash = std::move(other.m_hash);
+            m_equal = std::move(other.m_equal);
+            m_pool = std::move(other.m_pool);
             m_map = std::move(other.m_map);
+            m_oldMap = std::move(other.m_oldMap);
+            m_rehashStep = other.m_rehashStep;
+            m_migrated = other.m_migrated;
 
             other.m_capacity = 0;
             other.m_size = 0;
+            other.m_migrated = 0;
 
             return *this;
         }
@@ -141,71 +473,477 @@ namespace pSTL {
         /********************** Getters **********************/
 
         value_t& operator[](const key_t& key) {
-            size_t index = std::hash<key_t>{}(key) % m_capacity;
-            node_t* curr = m_map[index];
-
-            while (curr) {
-                if (curr->getKey() == key)
-                    return curr->getValue();
-                curr = curr->getNext();
-            }
-
-            node_t* newNode = new node_t(key, value_t{});
-            newNode->setNext(m_map[index]);
-            m_map[index] = newNode;
-            m_size++;
-            return newNode->getValue();
+            return try_emplace(key).first->getValue();
+        }
+        value_t& operator[](key_t&& key) {
+            return try_emplace(std::move(key)).first->getValue();
         }
 
         value_t& at(const key_t& key) {
-            size_t index = std::hash<key_t>{}(key) % m_capacity;
-            node_t* curr = m_map[index];
-            while (curr) {
-                if (curr->getKey() == key)
-                    return curr->getValue();
-                curr = curr->getNext();
-            }
-            throw std::out_of_range("Key not found");
+            return atImpl(key);
+        }
+        template <typename K, typename H = Hash, typename E = KeyEqual, typename = std::enable_if_t<transparent_v<H, E>>>
+        value_t& at(const K& key) {
+            return atImpl(key);
         }
 
         size_t size() const { return m_size; }
         bool empty() const { return m_size == 0; }
 
 
+        /********************** Iterators **********************/
+
+        iterator begin() { return iterator(this, 0); }
+        iterator end() { return iterator(); }
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(); }
+        const_iterator cbegin() const { return begin(); }
+        const_iterator cend() const { return end(); }
+
+
+        /********************** Buckets **********************/
+
+        size_t bucket_count() const { return m_capacity; }
+
+        // Number of entries chained in bucket n
+        size_t bucket_size(size_t n) const {
+            if (n >= m_capacity)
+                throw std::out_of_range("Bucket index out of range");
+
+            size_t count = 0;
+            for (node_t* curr = m_map[n]; curr; curr = curr->getNext())
+                count++;
+            return count;
+        }
+
+        float load_factor() const { return m_capacity ? static_cast<float>(m_size) / m_capacity : 0.0f; }
+
+        float max_load_factor() const { return m_maxLoad; }
+
+        // Number of old buckets moved per operation while an incremental
+        // rehash is running; 0 (the default) rehashes all at once
+        size_t rehash_step() const { return m_rehashStep; }
+        void rehash_step(size_t buckets) {
+            m_rehashStep = buckets;
+            if (buckets == 0)
+                finishRehash();
+        }
+
+        // True while an incremental rehash still has old buckets to move
+        bool rehashing() const { return m_oldMap.size() != 0; }
+
+        // Inserting past size() > ml * bucket_count() doubles the bucket count
+        void max_load_factor(float ml) {
+            if (!(ml > 0.0f))
+                throw std::invalid_argument("max_load_factor must be > 0");
+
+            m_maxLoad = ml;
+            while (m_size > m_capacity * m_maxLoad)
+                grow();
+        }
+
+
         /********************** Utility **********************/
 
+        // Inserts or overwrites
         void insert(const key_t& key, const value_t& value) {
-            size_t index = std::hash<key_t>{}(key) % m_capacity;
-            node_t* curr = m_map[index];
+            insert_or_assign(key, value);
+        }
 
-            while (curr) {
-                if (curr->getKey() == key) {
-                    curr->getValue() = value;
-                    return;
+        // Inserts value_t(args...) under key unless key is present. Nothing
+        // is allocated or constructed, and args are left untouched, when it is
+        template <typename... Args>
+        std::pair<node_t*, bool> try_emplace(const key_t& key, Args&&... args) {
+            return emplaceUnique(key, key, std::forward<Args>(args)...);
+        }
+        template <typename... Args>
+        std::pair<node_t*, bool> try_emplace(key_t&& key, Args&&... args) {
+            return emplaceUnique(key, std::move(key), std::forward<Args>(args)...);
+        }
+
+        template <typename M>
+        std::pair<node_t*, bool> insert_or_assign(const key_t& key, M&& obj) {
+            auto result = emplaceUnique(key, key, std::forward<M>(obj));
+            if (!result.second)
+                result.first->getValue() = std::forward<M>(obj);
+            return result;
+        }
+        template <typename M>
+        std::pair<node_t*, bool> insert_or_assign(key_t&& key, M&& obj) {
+            auto result = emplaceUnique(key, std::move(key), std::forward<M>(obj));
+            if (!result.second)
+                result.first->getValue() = std::forward<M>(obj);
+            return result;
+        }
+
+        // Like try_emplace, but key may be anything key_t is constructible
+        // from. With transparent Hash/KeyEqual it is probed as is; otherwise
+        // a key_t is built on the stack for the probe and moved into the node
+        template <typename K, typename... Args>
+        std::pair<node_t*, bool> emplace(K&& key, Args&&... args) {
+            if constexpr (std::is_same<std::decay_t<K>, key_t>::value || transparent_v<Hash, KeyEqual>) {
+                return emplaceUnique(key, std::forward<K>(key), std::forward<Args>(args)...);
+            }
+            else {
+                key_t probe(std::forward<K>(key));
+                return emplaceUnique(probe, std::move(probe), std::forward<Args>(args)...);
+            }
+        }
+
+        bool erase(const key_t& key) {
+            return eraseImpl(key);
+        }
+        template <typename K, typename H = Hash, typename E = KeyEqual, typename = std::enable_if_t<transparent_v<H, E>>>
+        bool erase(const K& key) {
+            return eraseImpl(key);
+        }
+
+        // Rehashes into at least newCapacity buckets (rounded up to a power
+        // of two) right away, completing any incremental rehash first
+        void reserve(size_t newCapacity) {
+            newCapacity = roundUpPow2(newCapacity);
+            if (newCapacity <= m_capacity)
+                return;
+
+            startRehash(newCapacity);
+            finishRehash();
+        }
+
+        node_t* find(const key_t& key) {
+            migrateStep();
+            return findIn(key, hashOf(key));
+        }
+        template <typename K, typename H = Hash, typename E = KeyEqual, typename = std::enable_if_t<transparent_v<H, E>>>
+        node_t* find(const K& key) {
+            migrateStep();
+            return findIn(key, hashOf(key));
+        }
+
+        // Read-only lookup: instead of advancing an incremental rehash like
+        // the non-const find, it checks both tables, so it writes nothing
+        // and concurrent calls on a const map are safe
+        const node_t* find(const key_t& key) const {
+            return findIn(key, hashOf(key));
+        }
+        template <typename K, typename H = Hash, typename E = KeyEqual, typename = std::enable_if_t<transparent_v<H, E>>>
+        const node_t* find(const K& key) const {
+            return findIn(key, hashOf(key));
+        }
+
+        bool contains(const key_t& key) const {
+            return find(key) != nullptr;
+        }
+        template <typename K, typename H = Hash, typename E = KeyEqual, typename = std::enable_if_t<transparent_v<H, E>>>
+        bool contains(const K& key) const {
+            return find(key) != nullptr;
+        }
+
+        // Keys handled per group by find_batch/insert_batch
+        static constexpr size_t BatchSize = 16;
+
+        // Looks up keys[0, n) and stores each key's node, or nullptr, in
+        // out[i]. Works BatchSize keys at a time: hashes the group and
+        // prefetches its bucket heads, prefetches the first node of each
+        // chain, then walks the chains, so the cache misses of a group
+        // overlap instead of being paid one key after another
+        void find_batch(const key_t* keys, size_t n, node_t** out) {
+            if (m_capacity == 0) {
+                std::fill(out, out + n, nullptr); // moved-from
+                return;
+            }
+            size_t hashes[BatchSize];
+            for (size_t base = 0; base < n; base += BatchSize) {
+                size_t count = std::min(BatchSize, n - base);
+                migrateStep();
+                prefetchGroup(keys + base, count, hashes);
+                for (size_t i = 0; i < count; i++)
+                    out[base + i] = findIn(keys[base + i], hashes[i]);
+            }
+        }
+
+        // insert(keys[i], values[i]) for i in [0, n), in order, with the same
+        // grouping and prefetching as find_batch. Reserves room for n new
+        // keys up front, so a batch with many existing keys may grow the
+        // table earlier than single inserts would
+        void insert_batch(const key_t* keys, const value_t* values, size_t n) {
+            size_t needed = m_size + n;
+            if (needed > m_capacity * m_maxLoad)
+                reserve(static_cast<size_t>(needed / m_maxLoad) + 1);
+
+            size_t hashes[BatchSize];
+            for (size_t base = 0; base < n; base += BatchSize) {
+                size_t count = std::min(BatchSize, n - base);
+                migrateStep();
+                prefetchGroup(keys + base, count, hashes);
+                for (size_t i = 0; i < count; i++) {
+                    auto result = emplaceHashed(hashes[i], keys[base + i], keys[base + i], values[base + i]);
+                    if (!result.second)
+                        result.first->getValue() = values[base + i];
                 }
-                curr = curr->getNext();
             }
+        }
 
-            node_t* newNode = new node_t(key, value);
-            newNode->setNext(m_map[index]);
-            m_map[index] = newNode;
-            m_size++;
+        void grow() {
+            reserve(m_capacity * 2);
         }
 
-        bool erase(const key_t& key) {
-            size_t index = std::hash<key_t>{}(key) % m_capacity;
-            node_t* curr = m_map[index];
+        // Calls fn(const key_t&, value) for every entry, in bucket order.
+        // fn must not insert or erase
+        template <typename Fn>
+        void for_each(Fn&& fn) {
+            for (auto& entry : *this)
+                fn(entry.first, entry.second);
+        }
+        template <typename Fn>
+        void for_each(Fn&& fn) const {
+            for (const auto& entry : *this)
+                fn(entry.first, entry.second);
+        }
+
+        // Calls fn(const key_t&, value_t&) for every entry, with the buckets
+        // split into contiguous ranges over threads workers (0 = one per
+        // hardware thread; small maps use fewer). fn runs concurrently and
+        // must not insert or erase. Completes a pending incremental rehash
+        // first. The first exception thrown by fn is rethrown after all
+        // workers have stopped
+        template <typename Fn>
+        void for_each_bucket_parallel(Fn&& fn, unsigned threads = 0) {
+            finishRehash();
+            if (threads == 0)
+                threads = std::max(1u, std::thread::hardware_concurrency());
+            size_t maxThreads = std::max<size_t>(1, m_capacity / MinParallelBuckets);
+            if (threads > maxThreads)
+                threads = static_cast<unsigned>(maxThreads);
+
+            // Ranges start on 64-bucket boundaries, one bitmap word each
+            size_t chunk = ((m_capacity + threads - 1) / threads + 63) & ~static_cast<size_t>(63);
+            auto scan = [&](size_t first, size_t last) {
+                for (size_t i = m_map.next_occupied(first); i < last; i = m_map.next_occupied(i + 1))
+                    for (node_t* curr = m_map[i]; curr; curr = curr->getNext())
+                        fn(curr->getKey(), curr->getValue());
+            };
+
+            std::vector<std::exception_ptr> errors(threads);
+            std::vector<std::thread> workers;
+            workers.reserve(threads);
+            for (unsigned t = 1; t < threads && t * chunk < m_capacity; t++) {
+                size_t first = t * chunk;
+                size_t last = std::min(m_capacity, first + chunk);
+                workers.emplace_back([&, t, first, last] {
+                    try { scan(first, last); }
+                    catch (...) { errors[t] = std::current_exception(); }
+                });
+            }
+            try { scan(0, std::min(m_capacity, chunk)); }
+            catch (...) { errors[0] = std::current_exception(); }
+
+            for (auto& worker : workers)
+                worker.join();
+            for (auto& error : errors)
+                if (error) std::rethrow_exception(error);
+        }
+
+        void swap(HashMap& other) noexcept {
+            std::swap(m_capacity, other.m_capacity);
+            std::swap(m_size, other.m_size);
+            std::swap(m_maxLoad, other.m_maxLoad);
+            std::swap(m_hash, other.m_hash);
+            std::swap(m_equal, other.m_equal);
+            m_pool.swap(other.m_pool);
+            m_map.swap(other.m_map);
+            m_oldMap.swap(other.m_oldMap);
+            std::swap(m_rehashStep, other.m_rehashStep);
+            std::swap(m_migrated, other.m_migrated);
+        }
+
+        // Destroys all entries. A pool owned by this map alone is released
+        // in one go; a shared pool gets the nodes back for reuse
+        void clear() {
+            destroyNodes();
+        }
+
+        std::shared_ptr<pool_t> pool() const { return m_pool; }
+
+        hasher hash_function() const { return m_hash; }
+        key_equal key_eq() const { return m_equal; }
+
+
+        /********************** Snapshot **********************/
+
+        // Writes the entries as a binary image (Snapshot.h) that FrozenHashMap
+        // maps and serves lookups from without deserializing. key_t and
+        // value_t must be trivially copyable, and the reading process must
+        // hash the same way (no per-process random seed). The image goes to
+        // a temporary file renamed over path, so processes that still map
+        // the previous image are unaffected. Works mid incremental rehash
+        void save(const std::string& path) const {
+            static_assert(std::is_trivially_copyable<key_t>::value && std::is_trivially_copyable<value_t>::value,
+                "HashMap::save: key and value types must be trivially copyable");
+            using entry_t = snapshot::Entry<key_t, value_t>;
+
+            // No more buckets than the live table(s), so each image bucket
+            // is a fixed set of live buckets and the image streams out in
+            // bucket order without sorting
+            size_t maxBuckets = rehashing() ? std::min(m_capacity, m_oldMap.size()) : m_capacity;
+            uint64_t buckets = snapshot::bucketCountFor(m_size, maxBuckets);
+
+            snapshot::Header header = {};
+            std::memcpy(header.magic, snapshot::Magic, sizeof(header.magic));
+            header.version = snapshot::Version;
+            header.byteOrder = snapshot::ByteOrderMark;
+            header.keySize = sizeof(key_t);
+            header.valueSize = sizeof(value_t);
+            header.entrySize = sizeof(entry_t);
+            header.entryAlign = alignof(entry_t);
+            header.count = m_size;
+            header.bucketCount = buckets;
+            header.entriesOffset = snapshot::entriesOffset<key_t, value_t>();
+
+            snapshot::Writer out(path);
+            out.write(&header, sizeof(header));
+            out.padTo(static_cast<size_t>(header.entriesOffset));
+
+            // One pass over the nodes: entries stream out while the bucket
+            // sizes are counted, staged in a zeroed buffer so padding bytes
+            // are written as zeros
+            constexpr size_t ChunkEntries = 4096;
+            std::vector<unsigned char> chunk(ChunkEntries * sizeof(entry_t));
+            std::vector<uint64_t> offsets(static_cast<size_t>(buckets) + 1, 0);
+            const node_t* first = nullptr;
+            const node_t* last = nullptr;
+            size_t buffered = 0;
+            forEachImageBucket(static_cast<size_t>(buckets), [&](size_t bucket, const node_t* node) {
+                if (!first)
+                    first = node;
+                last = node;
+                offsets[bucket + 1]++;
+
+                entry_t* entry = reinterpret_cast<entry_t*>(chunk.data()) + buffered;
+                std::memcpy(static_cast<void*>(&entry->key), &node->getKey(), sizeof(key_t));
+                std::memcpy(static_cast<void*>(&entry->value), &node->getValue(), sizeof(value_t));
+                if (++buffered == ChunkEntries) {
+                    out.write(chunk.data(), buffered * sizeof(entry_t));
+                    buffered = 0;
+                }
+            });
+            out.write(chunk.data(), buffered * sizeof(entry_t));
+
+            for (size_t i = 1; i < offsets.size(); i++)
+                offsets[i] += offsets[i - 1];
+            out.padTo(static_cast<size_t>(snapshot::offsetsOffset<key_t, value_t>(m_size)));
+            out.write(offsets.data(), offsets.size() * sizeof(uint64_t));
+
+            header.hashCheck = first ? snapshot::hashCheck(nodeHash(first), nodeHash(last)) : 0;
+            out.rewriteHeader(header);
+            out.commit();
+        }
+
+    private:
+        // Buckets per for_each_bucket_parallel worker below which extra
+        // threads cost more than they save
+        static constexpr size_t MinParallelBuckets = 4096;
+
+        static size_t roundUpPow2(size_t n) {
+            size_t pow2 = 1;
+            while (pow2 < n) pow2 <<= 1;
+            return pow2;
+        }
+
+        static constexpr bool caches_hash = cache_hash_code<key_t>::value;
+
+        // Bucket counts are powers of two, so the index is hashOf(key) masked
+        // instead of a division; hash_detail::finish (Hashers.h) mixes
+        // hashes that do not avalanche first
+        template <typename K>
+        size_t hashOf(const K& key) const {
+            return hash_detail::finish<Hash>(m_hash(key));
+        }
+
+        // Calls fn(imageBucket, node) for every node in image bucket order:
+        // buckets is a power of two no larger than either table, so image
+        // bucket j gathers the live buckets j, j + buckets, j + 2 * buckets...
+        template <typename Fn>
+        void forEachImageBucket(size_t buckets, Fn&& fn) const {
+            for (size_t j = 0; j < buckets; j++) {
+                for (size_t i = j; i < m_map.size(); i += buckets)
+                    for (const node_t* curr = m_map[i]; curr; curr = curr->getNext())
+                        fn(j, curr);
+                for (size_t i = j; i < m_oldMap.size(); i += buckets)
+                    for (const node_t* curr = m_oldMap[i]; curr; curr = curr->getNext())
+                        fn(j, curr);
+            }
+        }
+
+        // Rehashing reads the cached code instead of calling the hasher
+        size_t nodeHash(const node_t* node) const {
+            if constexpr (caches_hash)
+                return node->getHash();
+            else
+                return hashOf(node->getKey());
+        }
+
+        // With cached codes, keys are compared only when the full hashes match
+        template <typename K>
+        bool matches(const node_t* node, const K& key, size_t hash) const {
+            if constexpr (caches_hash) {
+                if (node->getHash() != hash)
+                    return false;
+            }
+            return m_equal(node->getKey(), key);
+        }
+
+        template <typename K>
+        node_t* findIn(const K& key, size_t hash) const {
+            if (m_capacity == 0)
+                return nullptr; // moved-from: no buckets until the first insert grows
+            for (node_t* curr = m_map[hash & (m_capacity - 1)]; curr; curr = curr->getNext()) {
+                if (matches(curr, key, hash))
+                    return curr;
+            }
+            // Buckets already moved are empty, so no need to check m_migrated
+            if (rehashing()) {
+                for (node_t* curr = m_oldMap[hash & (m_oldMap.size() - 1)]; curr; curr = curr->getNext()) {
+                    if (matches(curr, key, hash))
+                        return curr;
+                }
+            }
+            return nullptr;
+        }
+
+        template <typename K>
+        value_t& atImpl(const K& key) {
+            migrateStep();
+            node_t* node = findIn(key, hashOf(key));
+            if (!node)
+                throw std::out_of_range("Key not found");
+            return node->getValue();
+        }
+
+        template <typename K>
+        bool eraseImpl(const K& key) {
+            migrateStep();
+            if (m_capacity == 0)
+                return false; // moved-from
+            size_t hash = hashOf(key);
+            if (eraseFrom(m_map, hash & (m_capacity - 1), key, hash))
+                return true;
+            return rehashing() && eraseFrom(m_oldMap, hash & (m_oldMap.size() - 1), key, hash);
+        }
+
+        template <typename K>
+        bool eraseFrom(BucketArray<node_t>& table, size_t index, const K& key, size_t hash) {
+            node_t* curr = table[index];
             node_t* prev = nullptr;
 
             while (curr) {
-                if (curr->getKey() == key) {
+                if (matches(curr, key, hash)) {
                     if (prev) {
                         prev->setNext(curr->getNext());
                     }
                     else {
-                        m_map[index] = curr->getNext();
+                        table.set(index, curr->getNext());
                     }
-                    delete curr;
+                    destroyNode(curr);
                     m_size--;
                     return true;
                 }
@@ -215,67 +953,191 @@ namespace pSTL {
             return false;
         }
 
-        void reserve(size_t newCapacity) {
-            newCapacity = std::max<size_t>(newCapacity, 1);
-            if (newCapacity <= m_capacity)
+        // Probes with probe; only if it is absent allocates a node built from
+        // (key, args...). probe may alias key: it is not used after the node exists
+        template <typename P, typename K, typename... Args>
+        std::pair<node_t*, bool> emplaceUnique(const P& probe, K&& key, Args&&... args) {
+            migrateStep();
+            return emplaceHashed(hashOf(probe), probe, std::forward<K>(key), std::forward<Args>(args)...);
+        }
+
+        // emplaceUnique once hash = hashOf(probe) is known
+        template <typename P, typename K, typename... Args>
+        std::pair<node_t*, bool> emplaceHashed(size_t hash, const P& probe, K&& key, Args&&... args) {
+            if (node_t* existing = findIn(probe, hash))
+                return { existing, false };
+
+            growForInsert();
+            size_t index = hash & (m_capacity - 1);
+
+            node_t* newNode = createNode(std::forward<K>(key), std::forward<Args>(args)...);
+            newNode->setHash(hash);
+            m_map.push(index, newNode);
+            m_size++;
+            return { newNode, true };
+        }
+
+        // Hashes count keys into hashes, prefetching their bucket heads and
+        // then the first node of each chain. Only the current table is
+        // prefetched; the old one of an incremental rehash is not
+        void prefetchGroup(const key_t* keys, size_t count, size_t* hashes) const {
+            size_t mask = m_capacity - 1;
+            for (size_t i = 0; i < count; i++) {
+                hashes[i] = hashOf(keys[i]);
+                m_map.prefetch(hashes[i] & mask);
+            }
+            for (size_t i = 0; i < count; i++)
+                prefetchRead(m_map[hashes[i] & mask]);
+        }
+
+        // Grows before adding one entry if that would exceed the max load
+        // factor, incrementally when rehash_step() is set
+        void growForInsert() {
+            if (m_size + 1 <= m_capacity * m_maxLoad)
                 return;
 
-            std::vector<node_t*> newMap(newCapacity, nullptr);
-            for (size_t i = 0; i < m_capacity; ++i) {
-                node_t* current = m_map[i];
+            if (m_rehashStep) {
+                finishRehash();
+                startRehash(m_capacity ? m_capacity * 2 : 1);
+            }
+            else {
+                grow();
+            }
+        }
+
+        /********************** Rehashing **********************/
+
+        // Makes a new table current; the previous one becomes m_oldMap and
+        // still holds its nodes until migrateStep/finishRehash move them
+        void startRehash(size_t newCapacity) {
+            finishRehash();
+
+            BucketArray<node_t> newMap(newCapacity);
+            m_oldMap = std::move(m_map);
+            m_map = std::move(newMap);
+            m_capacity = newCapacity;
+            m_migrated = 0;
+        }
+
+        void migrateBuckets(size_t count) {
+            size_t end = m_migrated + count;
+            if (end > m_oldMap.size() || end < m_migrated)
+                end = m_oldMap.size();
+
+            for (; m_migrated < end; m_migrated++) {
+                node_t* current = m_oldMap[m_migrated];
+                if (!current)
+                    continue;
+                m_oldMap.set(m_migrated, nullptr);
                 while (current) {
                     node_t* next = current->getNext();
-                    size_t newIndex = std::hash<key_t>{}(current->getKey()) % newCapacity;
-                    current->setNext(newMap[newIndex]);
-                    newMap[newIndex] = current;
+                    m_map.push(nodeHash(current) & (m_capacity - 1), current);
                     current = next;
                 }
             }
-            m_map = std::move(newMap);
-            m_capacity = newCapacity;
+
+            if (m_migrated == m_oldMap.size()) {
+                m_oldMap.reset();
+                m_migrated = 0;
+            }
         }
 
-        node_t* find(const key_t& key) {
-            size_t index = std::hash<key_t>{}(key) % m_capacity;
-            node_t* curr = m_map[index];
-            while (curr) {
-                if (curr->getKey() == key)
-                    return curr;
-                curr = curr->getNext();
+        void migrateStep() {
+            if (rehashing())
+                migrateBuckets(m_rehashStep);
+        }
+
+        void finishRehash() {
+            if (rehashing())
+                migrateBuckets(m_oldMap.size());
+        }
+
+        // Clones other's entries into the (empty) m_map of the same capacity;
+        // entries still in other's old table land in their new buckets
+        void copyNodes(const HashMap& other) {
+            for (size_t i = other.m_map.next_occupied(0); i < m_capacity; i = other.m_map.next_occupied(i + 1)) {
+                node_t* head = nullptr;
+                node_t** currThis = &head; // where the next clone is linked, keeping chain order
+                for (node_t* currOther = other.m_map[i]; currOther; currOther = currOther->getNext()) {
+                    *currThis = cloneNode(currOther);
+                    currThis = &((*currThis)->nextRef());
+                }
+                m_map.set(i, head);
+            }
+            for (size_t i = other.m_oldMap.next_occupied(0); i < other.m_oldMap.size(); i = other.m_oldMap.next_occupied(i + 1)) {
+                for (node_t* currOther = other.m_oldMap[i]; currOther; currOther = currOther->getNext()) {
+                    node_t* node = cloneNode(currOther);
+                    m_map.push(nodeHash(node) & (m_capacity - 1), node);
+                }
             }
-            return nullptr;
         }
 
-        void grow() {
-            reserve(m_capacity * 2);
+        template <typename K, typename... Args>
+        node_t* createNode(K&& key, Args&&... args) {
+            if (!m_pool)
+                m_pool = std::make_shared<pool_t>(); // moved-from
+
+            node_t* node = m_pool->allocate();
+            try {
+                ::new (static_cast<void*>(node)) node_t(std::piecewise_construct, std::forward<K>(key), std::forward<Args>(args)...);
+            }
+            catch (...) {
+                m_pool->deallocate(node);
+                throw;
+            }
+            return node;
         }
 
-        void swap(HashMap& other) noexcept {
-            std::swap(m_capacity, other.m_capacity);
-            std::swap(m_size, other.m_size);
-            m_map.swap(other.m_map);
+        node_t* cloneNode(const node_t* other) {
+            node_t* node = createNode(other->getKey(), other->getValue());
+            if constexpr (caches_hash)
+                node->setHash(other->getHash());
+            return node;
         }
 
-        void clear() {
-            for (auto& head : m_map) {
-                while (head) {
-                    node_t* temp = head;
-                    head = head->getNext();
-                    delete temp;
+        void destroyNode(node_t* node) {
+            node->~node_t();
+            m_pool->deallocate(node);
+        }
+
+        void destroyNodes() {
+            finishRehash();
+
+            bool owned = m_pool && m_pool.use_count() == 1;
+            if (!owned || !std::is_trivially_destructible<node_t>::value) {
+                for (size_t i = m_map.next_occupied(0); i < m_map.size(); i = m_map.next_occupied(i + 1)) {
+                    node_t* curr = m_map[i];
+                    while (curr) {
+                        node_t* temp = curr;
+                        curr = curr->getNext();
+                        if (owned)
+                            temp->~node_t();
+                        else
+                            destroyNode(temp);
+                    }
                 }
             }
+            m_map.clear();
+            if (owned)
+                m_pool->release();
             m_size = 0;
         }
 
-    private:
         size_t m_capacity;
         size_t m_size;
-        std::vector<node_t*> m_map;
+        float m_maxLoad;
+        Hash m_hash;
+        KeyEqual m_equal;
+        std::shared_ptr<pool_t> m_pool;
+        BucketArray<node_t> m_map;
         /*
-        * Vector of linked list heads
+        * Array of linked list heads
         * Each element is a pointer to a head of a separate linked list
         * Not the most optimal solution for closed addressing hash maps
         * Better soltuion would be to use 2 arrays only (cache locality)
         */
+        BucketArray<node_t> m_oldMap; // previous table during an incremental rehash, else empty
+        size_t m_rehashStep;
+        size_t m_migrated;            // old buckets [0, m_migrated) are already moved
     };
 }
\ No newline at end of file
@@ -0,0 +1,282 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+
+namespace pSTL {
+    /*
+    * Hashers for HashMap and friends.
+    *
+    * A hasher declaring `using is_avalanching = void;` promises that every
+    * output bit depends on every input bit, so maps use its value as is
+    * instead of running their own bit mixer on top. All hashers below
+    * declare it; std::hash (the identity for integers in libstdc++ and
+    * MSVC) does not, and keeps getting mixed
+    */
+    template <typename H, typename = void>
+    struct is_avalanching : std::false_type {};
+    template <typename H>
+    struct is_avalanching<H, std::void_t<typename H::is_avalanching>> : std::true_type {};
+
+    namespace hash_detail {
+        // Full 64x64 -> 128-bit product: a gets the low half, b the high half
+        inline void mum(uint64_t& a, uint64_t& b) noexcept {
+#if defined(__SIZEOF_INT128__)
+            __uint128_t r = static_cast<__uint128_t>(a) * b;
+            a = static_cast<uint64_t>(r);
+            b = static_cast<uint64_t>(r >> 64);
+#elif defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+            a = _umul128(a, b, &b);
+#else
+            uint64_t aLow = a & 0xFFFFFFFFull, aHigh = a >> 32;
+            uint64_t bLow = b & 0xFFFFFFFFull, bHigh = b >> 32;
+            uint64_t ll = aLow * bLow, lh = aLow * bHigh, hl = aHigh * bLow, hh = aHigh * bHigh;
+            uint64_t mid = (ll >> 32) + (lh & 0xFFFFFFFFull) + (hl & 0xFFFFFFFFull);
+            a = (ll & 0xFFFFFFFFull) | (mid << 32);
+            b = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+#endif
+        }
+
+        // The product folded by xor of its two halves
+        inline uint64_t mix(uint64_t a, uint64_t b) noexcept {
+            mum(a, b);
+            return a ^ b;
+        }
+
+        inline uint64_t read8(const unsigned char* p) noexcept {
+            uint64_t v;
+            std::memcpy(&v, p, 8);
+            return v;
+        }
+        inline uint64_t read4(const unsigned char* p) noexcept {
+            uint32_t v;
+            std::memcpy(&v, p, 4);
+            return v;
+        }
+        // 1..3 bytes: first, middle and last
+        inline uint64_t read3(const unsigned char* p, size_t len) noexcept {
+            return (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[len >> 1]) << 8) | p[len - 1];
+        }
+
+        // splitmix64 finalizer: constexpr, unlike the 128-bit multiply in mix
+        constexpr uint64_t splitmix(uint64_t x) noexcept {
+            x += 0x9E3779B97F4A7C15ull;
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+            return x ^ (x >> 31);
+        }
+
+        // Final step from a Hash result to the hash the tables mask. std::hash
+        // is the identity for integers, so other hashers get a multiply-xorshift
+        // that spreads the high bits into the low, masked ones; is_avalanching
+        // hashers pass through. HashMap and the images built from it
+        // (FrozenHashMap, PerfectHashMap) must agree bit for bit, so they all
+        // call this one
+        template <typename Hash>
+        constexpr size_t finish(size_t hash) noexcept {
+            if constexpr (is_avalanching<Hash>::value)
+                return hash;
+
+            uint64_t h = static_cast<uint64_t>(hash);
+            h ^= h >> 33;
+            h *= 0xFF51AFD7ED558CCDull;
+            h ^= h >> 33;
+            return static_cast<size_t>(h);
+        }
+
+        constexpr uint64_t Secret[4] = { 0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull };
+    }
+
+    /*
+    * wyhash-style byte hash: inputs up to 16 bytes take two overlapping
+    * loads and one 128-bit multiply, longer inputs run three independent
+    * 16-byte lanes per 48-byte block. Reads are unaligned-safe (memcpy);
+    * the result depends on the host's byte order
+    */
+    inline uint64_t hash_bytes(const void* data, size_t len, uint64_t seed = 0) noexcept {
+        using namespace hash_detail;
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        seed ^= mix(seed ^ Secret[0], Secret[1]);
+
+        uint64_t a, b;
+        if (len <= 16) {
+            if (len >= 4) {
+                size_t shift = (len >> 3) << 2;
+                a = (read4(p) << 32) | read4(p + shift);
+                b = (read4(p + len - 4) << 32) | read4(p + len - 4 - shift);
+            }
+            else if (len > 0) {
+                a = read3(p, len);
+                b = 0;
+            }
+            else {
+                a = b = 0;
+            }
+        }
+        else {
+            size_t i = len;
+            if (i > 48) {
+                uint64_t lane1 = seed, lane2 = seed;
+                do {
+                    seed = mix(read8(p) ^ Secret[1], read8(p + 8) ^ seed);
+                    lane1 = mix(read8(p + 16) ^ Secret[2], read8(p + 24) ^ lane1);
+                    lane2 = mix(read8(p + 32) ^ Secret[3], read8(p + 40) ^ lane2);
+                    p += 48;
+                    i -= 48;
+                } while (i > 48);
+                seed ^= lane1 ^ lane2;
+            }
+            while (i > 16) {
+                seed = mix(read8(p) ^ Secret[1], read8(p + 8) ^ seed);
+                p += 16;
+                i -= 16;
+            }
+            a = read8(p + i - 16);
+            b = read8(p + i - 8);
+        }
+        a ^= Secret[1];
+        b ^= seed;
+        mum(a, b);
+        return mix(a ^ Secret[0] ^ len, b ^ Secret[1]);
+    }
+
+    // Multiply-shift mixer for integers: one 128-bit multiply by a golden-ratio
+    // constant, high and low halves folded together
+    inline uint64_t hash_int(uint64_t x) noexcept {
+        return hash_detail::mix(x, 0x9E3779B97F4A7C15ull);
+    }
+
+    // Folds h into seed (the boost::hash_combine recipe, widened to 64 bits);
+    // order-dependent, so combine(a, b) != combine(b, a)
+    inline size_t hash_combine(size_t seed, size_t h) noexcept {
+        return seed ^ (h + static_cast<size_t>(0x9E3779B97F4A7C15ull) + (seed << 6) + (seed >> 2));
+    }
+
+    /********************** Hashers **********************/
+
+    // Integers, enums and pointers
+    struct IntHash {
+        using is_avalanching = void;
+
+        template <typename T, typename = std::enable_if_t<std::is_integral<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value>>
+        size_t operator()(T value) const noexcept {
+            if constexpr (std::is_pointer<T>::value)
+                return static_cast<size_t>(hash_int(reinterpret_cast<uintptr_t>(value)));
+            else
+                return static_cast<size_t>(hash_int(static_cast<uint64_t>(value)));
+        }
+    };
+
+    // Strings and byte spans. Transparent: a map keyed by std::string can
+    // be probed with string_view or const char* (use std::equal_to<> as KeyEqual)
+    struct BytesHash {
+        using is_avalanching = void;
+        using is_transparent = void;
+
+        size_t operator()(std::string_view s) const noexcept {
+            return static_cast<size_t>(hash_bytes(s.data(), s.size()));
+        }
+        size_t operator()(const std::string& s) const noexcept {
+            return static_cast<size_t>(hash_bytes(s.data(), s.size()));
+        }
+        size_t operator()(const char* s) const noexcept {
+            return static_cast<size_t>(hash_bytes(s, std::strlen(s)));
+        }
+    };
+
+    /*
+    * Hasher usable in constant expressions, for tables built at compile
+    * time (StaticPerfectHashMap). Integers go through splitmix; strings
+    * are folded 8 bytes at a time, assembled with shifts rather than
+    * loaded, then finished with splitmix. Slower than BytesHash on long
+    * strings, but gives the same value at compile time and at run time
+    */
+    struct ConstexprHash {
+        using is_avalanching = void;
+
+        template <typename T, typename = std::enable_if_t<std::is_integral<T>::value || std::is_enum<T>::value>>
+        constexpr size_t operator()(T value) const noexcept {
+            return static_cast<size_t>(hash_detail::splitmix(static_cast<uint64_t>(value)));
+        }
+
+        constexpr size_t operator()(std::string_view s) const noexcept {
+            uint64_t h = 0x243F6A8885A308D3ull ^ s.size();
+            size_t i = 0;
+            for (; i + 8 <= s.size(); i += 8)
+                h = (h ^ word(s, i, 8)) * 0x9E3779B97F4A7C15ull;
+            if (i < s.size())
+                h = (h ^ word(s, i, s.size() - i)) * 0x9E3779B97F4A7C15ull;
+            return static_cast<size_t>(hash_detail::splitmix(h));
+        }
+
+    private:
+        // Little-endian value of s[at, at + len), len <= 8
+        static constexpr uint64_t word(std::string_view s, size_t at, size_t len) noexcept {
+            uint64_t w = 0;
+            for (size_t i = 0; i < len; i++)
+                w |= static_cast<uint64_t>(static_cast<unsigned char>(s[at + i])) << (8 * i);
+            return w;
+        }
+    };
+
+    template <typename T, typename = void>
+    struct FastHash;
+
+    // std::pair / std::tuple, combining FastHash of every element
+    struct CombineHash {
+        using is_avalanching = void;
+
+        template <typename A, typename B>
+        size_t operator()(const std::pair<A, B>& p) const noexcept(noexcept(FastHash<A>{}(p.first)) && noexcept(FastHash<B>{}(p.second))) {
+            return finish(hash_combine(FastHash<A>{}(p.first), FastHash<B>{}(p.second)));
+        }
+        template <typename... Ts>
+        size_t operator()(const std::tuple<Ts...>& t) const {
+            size_t seed = 0;
+            std::apply([&](const Ts&... elements) { ((seed = hash_combine(seed, FastHash<Ts>{}(elements))), ...); }, t);
+            return finish(seed);
+        }
+
+    private:
+        // hash_combine alone keeps some linearity; one more multiply avalanches it
+        static size_t finish(size_t seed) noexcept {
+            return static_cast<size_t>(hash_int(static_cast<uint64_t>(seed)));
+        }
+    };
+
+    /*
+    * Default-quality hasher for K: IntHash for integers/enums/pointers,
+    * BytesHash for strings, CombineHash for pairs and tuples, and std::hash
+    * followed by the integer mixer for anything else
+    */
+    template <typename T, typename>
+    struct FastHash {
+        using is_avalanching = void;
+
+        size_t operator()(const T& value) const noexcept(noexcept(std::hash<T>{}(value))) {
+            return IntHash{}(static_cast<uint64_t>(std::hash<T>{}(value)));
+        }
+    };
+    template <typename T>
+    struct FastHash<T, std::enable_if_t<std::is_integral<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value>> : IntHash {};
+    template <>
+    struct FastHash<std::string> : BytesHash {};
+    template <>
+    struct FastHash<std::string_view> : BytesHash {};
+    template <typename A, typename B>
+    struct FastHash<std::pair<A, B>> : CombineHash {};
+    template <typename... Ts>
+    struct FastHash<std::tuple<Ts...>> : CombineHash {};
+}
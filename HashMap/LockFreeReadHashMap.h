@@ -0,0 +1,353 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <cstdint>
+
+#include "Epoch.h"
+#include "Hashers.h"
+
+
+namespace pSTL {
+    // Chain node of a LockFreeReadHashMap. Key, value and hash never change
+    // after publication; an update links in a replacement node instead
+    template <typename key_t, typename value_t>
+    class AtomicNode {
+    public:
+        template <typename K, typename V>
+        AtomicNode(size_t hash, K&& key, V&& value, AtomicNode* next)
+            : m_hash(hash), m_key(std::forward<K>(key)), m_val(std::forward<V>(value)), m_next(next) {
+        }
+
+        size_t getHash() const {
+            return m_hash;
+        }
+        const key_t& getKey() const {
+            return m_key;
+        }
+        const value_t& getValue() const {
+            return m_val;
+        }
+        AtomicNode* getNext() const {
+            return m_next.load(std::memory_order_acquire);
+        }
+        std::atomic<AtomicNode*>& nextRef() {
+            return m_next;
+        }
+
+    private:
+        const size_t m_hash;
+        const key_t m_key;
+        const value_t m_val;
+        std::atomic<AtomicNode*> m_next;
+    };
+
+    /*
+    * Hash map for lookup-dominated data with rare updates.
+    *
+    * Same chained layout as HashMap, but bucket heads and next pointers
+    * are atomics and nodes are immutable once published. find/at/contains/
+    * visit never lock and never write shared data: they announce an epoch
+    * in the calling thread's own record (epoch::Guard) and walk the chain
+    * with acquire loads. Writers serialize on one mutex, build a node fully
+    * and then publish it with a single release store of the pointer that
+    * links it in, so a reader sees either the old or the new chain.
+    *
+    * Erased and replaced nodes, and whole tables left behind by growth or
+    * clear, are retired with the epoch they were unlinked in and freed by
+    * a later writer once epoch::Domain shows no reader can still hold them.
+    * Growth copies every entry into a new table and swaps the table
+    * pointer, since relinking live nodes would send readers down the
+    * wrong chain. Memory is freed in the destructor, which must not race
+    * with readers
+    */
+    template <typename key_t, typename value_t, typename Hash = std::hash<key_t>, typename KeyEqual = std::equal_to<key_t>>
+    class LockFreeReadHashMap {
+    public:
+        using node_t = AtomicNode<key_t, value_t>;
+        using hasher = Hash;
+        using key_equal = KeyEqual;
+
+        // Retired objects buffered before a writer tries to free them
+        static constexpr size_t ReclaimThreshold = 64;
+
+
+        /********************** Constructors **********************/
+
+        explicit LockFreeReadHashMap(size_t capacity = 16)
+            : m_table(createTable(roundUpPow2(capacity))), m_size(0) {
+        }
+
+        LockFreeReadHashMap(std::initializer_list<std::pair<key_t, value_t>> initList)
+            : LockFreeReadHashMap(initList.size()) {
+            for (const auto& p : initList) {
+                insert(p.first, p.second);
+            }
+        }
+
+        LockFreeReadHashMap(const LockFreeReadHashMap&) = delete;
+        LockFreeReadHashMap& operator=(const LockFreeReadHashMap&) = delete;
+
+        ~LockFreeReadHashMap() {
+            destroyTable(m_table.load(std::memory_order_relaxed));
+            for (Retired& retired : m_retired)
+                retired.destroy(retired.ptr);
+        }
+
+
+        /********************** Getters **********************/
+
+        std::optional<value_t> find(const key_t& key) const {
+            epoch::Guard guard;
+            const node_t* node = findNode(key);
+            if (!node)
+                return std::nullopt;
+            return node->getValue();
+        }
+
+        value_t at(const key_t& key) const {
+            epoch::Guard guard;
+            const node_t* node = findNode(key);
+            if (!node)
+                throw std::out_of_range("Key not found");
+            return node->getValue();
+        }
+
+        bool contains(const key_t& key) const {
+            epoch::Guard guard;
+            return findNode(key) != nullptr;
+        }
+
+        // Calls fn(const value_t&) without copying the value; true if found.
+        // fn must not keep the reference after it returns
+        template <typename Fn>
+        bool visit(const key_t& key, Fn&& fn) const {
+            epoch::Guard guard;
+            const node_t* node = findNode(key);
+            if (!node)
+                return false;
+            fn(node->getValue());
+            return true;
+        }
+
+        size_t size() const { return m_size.load(std::memory_order_relaxed); }
+        bool empty() const { return size() == 0; }
+
+        size_t bucket_count() const {
+            return m_table.load(std::memory_order_acquire)->capacity;
+        }
+
+        // Objects retired but not yet freed
+        size_t pending_reclaim() const {
+            std::lock_guard<std::mutex> lock(m_writeLock);
+            return m_retired.size();
+        }
+
+
+        /********************** Utility **********************/
+
+        // Inserts or replaces; true if the key was new
+        bool insert(const key_t& key, const value_t& value) {
+            std::lock_guard<std::mutex> lock(m_writeLock);
+            reserveRetired();
+            size_t hash = hashOf(key);
+            Table* table = m_table.load(std::memory_order_relaxed);
+            std::atomic<node_t*>* link = &table->heads[hash & (table->capacity - 1)];
+
+            for (node_t* curr = link->load(std::memory_order_relaxed); curr; curr = curr->getNext()) {
+                if (curr->getHash() == hash && m_equal(curr->getKey(), key)) {
+                    link->store(new node_t(hash, key, value, curr->getNext()), std::memory_order_release);
+                    retire(curr, &deleteNode);
+                    reclaim();
+                    return false;
+                }
+                link = &curr->nextRef();
+            }
+
+            if (m_size.load(std::memory_order_relaxed) + 1 > table->capacity)
+                table = rebuild(table->capacity * 2);
+            link = &table->heads[hash & (table->capacity - 1)];
+            link->store(new node_t(hash, key, value, link->load(std::memory_order_relaxed)), std::memory_order_release);
+            m_size.fetch_add(1, std::memory_order_relaxed);
+            reclaim();
+            return true;
+        }
+
+        bool erase(const key_t& key) {
+            std::lock_guard<std::mutex> lock(m_writeLock);
+            reserveRetired();
+            size_t hash = hashOf(key);
+            Table* table = m_table.load(std::memory_order_relaxed);
+            std::atomic<node_t*>* link = &table->heads[hash & (table->capacity - 1)];
+
+            for (node_t* curr = link->load(std::memory_order_relaxed); curr; curr = curr->getNext()) {
+                if (curr->getHash() == hash && m_equal(curr->getKey(), key)) {
+                    // Readers already on curr still reach the rest of the chain
+                    link->store(curr->getNext(), std::memory_order_release);
+                    m_size.fetch_sub(1, std::memory_order_relaxed);
+                    retire(curr, &deleteNode);
+                    reclaim();
+                    return true;
+                }
+                link = &curr->nextRef();
+            }
+            return false;
+        }
+
+        void reserve(size_t capacity) {
+            std::lock_guard<std::mutex> lock(m_writeLock);
+            reserveRetired();
+            capacity = roundUpPow2(capacity);
+            if (capacity > m_table.load(std::memory_order_relaxed)->capacity)
+                rebuild(capacity);
+            reclaim();
+        }
+
+        void clear() {
+            std::lock_guard<std::mutex> lock(m_writeLock);
+            reserveRetired();
+            Table* old = m_table.load(std::memory_order_relaxed);
+            m_table.store(createTable(old->capacity), std::memory_order_release);
+            m_size.store(0, std::memory_order_relaxed);
+            retire(old, &destroyTableErased);
+            reclaim();
+        }
+
+        // Frees whatever no reader can reach anymore, advancing the epoch
+        // as far as current readers allow
+        void reclaim_now() {
+            std::lock_guard<std::mutex> lock(m_writeLock);
+            collect();
+        }
+
+    private:
+        struct Table {
+            size_t capacity;                // power of two
+            std::atomic<node_t*>* heads;
+        };
+
+        struct Retired {
+            uint64_t epoch;
+            void* ptr;
+            void (*destroy)(void*);
+        };
+
+        static size_t roundUpPow2(size_t n) noexcept {
+            size_t pow2 = 1;
+            while (pow2 < n) pow2 <<= 1;
+            return pow2;
+        }
+
+        size_t hashOf(const key_t& key) const {
+            return hash_detail::finish<Hash>(m_hash(key));
+        }
+
+        const node_t* findNode(const key_t& key) const {
+            size_t hash = hashOf(key);
+            const Table* table = m_table.load(std::memory_order_acquire);
+            for (const node_t* curr = table->heads[hash & (table->capacity - 1)].load(std::memory_order_acquire); curr; curr = curr->getNext()) {
+                if (curr->getHash() == hash && m_equal(curr->getKey(), key))
+                    return curr;
+            }
+            return nullptr;
+        }
+
+        static Table* createTable(size_t capacity) {
+            Table* table = new Table{ capacity, new std::atomic<node_t*>[capacity] };
+            for (size_t i = 0; i < capacity; i++)
+                table->heads[i].store(nullptr, std::memory_order_relaxed);
+            return table;
+        }
+
+        static void destroyTable(Table* table) noexcept {
+            for (size_t i = 0; i < table->capacity; i++) {
+                node_t* curr = table->heads[i].load(std::memory_order_relaxed);
+                while (curr) {
+                    node_t* next = curr->getNext();
+                    delete curr;
+                    curr = next;
+                }
+            }
+            destroyTableArray(table);
+        }
+
+        static void destroyTableArray(Table* table) noexcept {
+            delete[] table->heads;
+            delete table;
+        }
+
+        static void deleteNode(void* node) noexcept {
+            delete static_cast<node_t*>(node);
+        }
+        static void destroyTableErased(void* table) noexcept {
+            destroyTable(static_cast<Table*>(table));
+        }
+
+        // Copies every entry into a table of the given capacity and makes it
+        // current. The old table and its nodes are retired as one object
+        Table* rebuild(size_t capacity) {
+            Table* old = m_table.load(std::memory_order_relaxed);
+            Table* table = createTable(capacity);
+            try {
+                for (size_t i = 0; i < old->capacity; i++) {
+                    for (node_t* curr = old->heads[i].load(std::memory_order_relaxed); curr; curr = curr->getNext()) {
+                        std::atomic<node_t*>& head = table->heads[curr->getHash() & (capacity - 1)];
+                        head.store(new node_t(curr->getHash(), curr->getKey(), curr->getValue(), head.load(std::memory_order_relaxed)),
+                            std::memory_order_relaxed);
+                    }
+                }
+            }
+            catch (...) {
+                destroyTable(table);
+                throw;
+            }
+            m_table.store(table, std::memory_order_release);
+            retire(old, &destroyTableErased);
+            return table;
+        }
+
+        // Writers retire at most one object each, after publishing their
+        // change; making room up front means that push_back cannot throw
+        // and strand an unlinked node
+        void reserveRetired() {
+            if (m_retired.size() == m_retired.capacity())
+                m_retired.reserve(2 * m_retired.size() + 1);
+        }
+
+        void retire(void* ptr, void (*destroy)(void*)) {
+            m_retired.push_back(Retired{ epoch::global_domain().retire_epoch(), ptr, destroy });
+        }
+
+        void reclaim() {
+            if (m_retired.size() >= ReclaimThreshold)
+                collect();
+        }
+
+        void collect() {
+            epoch::Domain& domain = epoch::global_domain();
+            domain.try_advance();
+            uint64_t epoch = domain.try_advance();
+
+            // m_retired is in non-decreasing epoch order
+            size_t freed = 0;
+            while (freed < m_retired.size() && m_retired[freed].epoch + 2 <= epoch) {
+                m_retired[freed].destroy(m_retired[freed].ptr);
+                freed++;
+            }
+            m_retired.erase(m_retired.begin(), m_retired.begin() + freed);
+        }
+
+        std::atomic<Table*> m_table;
+        std::atomic<size_t> m_size;
+        Hash m_hash;
+        KeyEqual m_equal;
+        mutable std::mutex m_writeLock;     // serializes writers; readers never take it
+        std::vector<Retired> m_retired;     // guarded by m_writeLock
+    };
+}
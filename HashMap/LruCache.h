@@ -0,0 +1,516 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <utility>
+#include <cstdint>
+
+#include "ConcurrentHashMap.h"
+#include "HashMap.h"
+
+
+namespace pSTL {
+    namespace cache_detail {
+        // Mapped value of the cache's HashMap: the value plus the recency
+        // links, so an entry costs one node allocation and nothing else
+        template <typename key_t, typename value_t>
+        struct Slot {
+            template <typename V>
+            Slot(V&& v, size_t c)
+                : value(std::forward<V>(v)), charge(c) {
+            }
+
+            value_t value;
+            Slot* prev = nullptr;
+            Slot* next = nullptr;
+            const key_t* key = nullptr;             // the owning node's key
+            size_t charge;
+            mutable std::atomic<bool> referenced{ false };  // ClockPolicy's reference bit, set through const slots by shared hits
+        };
+
+        // Intrusive doubly-linked list of slots, newest at the front
+        template <typename Slot>
+        class RecencyList {
+        public:
+            using slot_t = Slot;
+
+            Slot* front() const { return m_front; }
+            Slot* back() const { return m_back; }
+
+            void push_front(Slot* slot) {
+                slot->prev = nullptr;
+                slot->next = m_front;
+                if (m_front)
+                    m_front->prev = slot;
+                else
+                    m_back = slot;
+                m_front = slot;
+            }
+
+            void remove(Slot* slot) {
+                if (slot->prev)
+                    slot->prev->next = slot->next;
+                else
+                    m_front = slot->next;
+                if (slot->next)
+                    slot->next->prev = slot->prev;
+                else
+                    m_back = slot->prev;
+            }
+
+            void move_to_front(Slot* slot) {
+                if (slot == m_front)
+                    return;
+                remove(slot);
+                push_front(slot);
+            }
+
+            void clear() {
+                m_front = m_back = nullptr;
+            }
+
+        private:
+            Slot* m_front = nullptr;
+            Slot* m_back = nullptr;
+        };
+    }
+
+
+    /********************** Policies **********************/
+
+    /*
+    * Eviction policies for BoundedCache. A policy provides
+    *
+    *     static constexpr bool shared_hits;
+    *     template <typename List> static void onHit(List& list, typename List::slot_t* slot);
+    *     template <typename List> static typename List::slot_t* victim(List& list);
+    *
+    * onHit runs on every get, victim picks the entry to evict next from a
+    * non-empty list. A shared_hits policy's onHit takes a const list and
+    * slot and only sets the slot's atomic reference bit, so hits may run
+    * under a shared lock
+    */
+
+    // Least recently used: a hit moves the entry to the front, the victim
+    // is the back
+    struct LruPolicy {
+        static constexpr bool shared_hits = false;
+
+        template <typename List>
+        static void onHit(List& list, typename List::slot_t* slot) {
+            list.move_to_front(slot);
+        }
+
+        template <typename List>
+        static typename List::slot_t* victim(List& list) {
+            return list.back();
+        }
+    };
+
+    // CLOCK (second chance): a hit only sets the entry's reference bit, and
+    // the victim search walks from the back, clearing set bits and giving
+    // those entries another round at the front. Hits never relink, so they
+    // write at most one byte and can share a lock. Eviction is amortized
+    // O(1): every bit cleared was set by one hit
+    struct ClockPolicy {
+        static constexpr bool shared_hits = true;
+
+        template <typename List>
+        static void onHit(const List&, const typename List::slot_t* slot) {
+            // Skip the store when set already, keeping hot lines clean
+            if (!slot->referenced.load(std::memory_order_relaxed))
+                slot->referenced.store(true, std::memory_order_relaxed);
+        }
+
+        template <typename List>
+        static typename List::slot_t* victim(List& list) {
+            typename List::slot_t* slot = list.back();
+            while (slot->referenced.load(std::memory_order_relaxed)) {
+                slot->referenced.store(false, std::memory_order_relaxed);
+                list.move_to_front(slot);
+                slot = list.back();
+            }
+            return slot;
+        }
+    };
+
+    struct CacheStats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t insertions = 0;
+        uint64_t evictions = 0;
+
+        double hit_ratio() const {
+            uint64_t lookups = hits + misses;
+            return lookups ? static_cast<double>(hits) / lookups : 0.0;
+        }
+
+        CacheStats& operator+=(const CacheStats& other) {
+            hits += other.hits;
+            misses += other.misses;
+            insertions += other.insertions;
+            evictions += other.evictions;
+            return *this;
+        }
+    };
+
+
+    /*
+    * Bounded key/value cache on top of HashMap.
+    *
+    * Every entry has a charge (1 by default) and the sum of charges stays
+    * within capacity(): count entries with the default charge, or bytes by
+    * passing each value's size to put. When a put goes over budget,
+    * entries chosen by Policy are evicted until it fits again; the
+    * eviction callback sees each of them (key and mutable value) just
+    * before it is destroyed. erase, clear and overwrites do not call it.
+    *
+    * The recency list is intrusive: its links live in the HashMap node
+    * next to the value, so get, put and eviction are O(1) with a single
+    * allocation per entry. Pointers returned by get/peek stay valid until
+    * the entry is evicted, erased or overwritten. Not thread-safe; see
+    * ShardedCache. Use through LruCache or ClockCache
+    */
+    template <typename key_t, typename value_t, typename Policy = LruPolicy, typename Hash = std::hash<key_t>, typename KeyEqual = std::equal_to<key_t>>
+    class BoundedCache {
+        using slot_t = cache_detail::Slot<key_t, value_t>;
+        using map_t = HashMap<key_t, slot_t, Hash, KeyEqual>;
+        using node_t = typename map_t::node_t;
+
+    public:
+        using key_type = key_t;
+        using mapped_type = value_t;
+        using policy = Policy;
+        using hasher = Hash;
+        using key_equal = KeyEqual;
+        using evict_fn = std::function<void(const key_t&, value_t&)>;
+
+
+        /********************** Constructors **********************/
+
+        explicit BoundedCache(size_t capacity, evict_fn onEvict = nullptr, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual())
+            : m_map(16, hash, equal), m_capacity(capacity), m_usage(0), m_onEvict(std::move(onEvict)) {
+        }
+
+        // Slots point at each other and at their nodes' keys
+        BoundedCache(const BoundedCache&) = delete;
+        BoundedCache& operator=(const BoundedCache&) = delete;
+
+
+        /********************** Getters **********************/
+
+        // The cached value, marked as used, or nullptr; counts a hit or miss
+        value_t* get(const key_t& key) {
+            node_t* node = m_map.find(key);
+            if (!node) {
+                m_stats.misses++;
+                return nullptr;
+            }
+            m_stats.hits++;
+            Policy::onHit(m_list, &node->getValue());
+            return &node->getValue().value;
+        }
+
+        // get for policies with shared_hits, callable concurrently with other
+        // get_shared/peek/contains calls (e.g. under a shared lock): only the
+        // reference bit is written, and the counters are left to the caller
+        const value_t* get_shared(const key_t& key) const {
+            static_assert(Policy::shared_hits, "BoundedCache::get_shared: the policy relinks entries on hits");
+            const node_t* node = m_map.find(key);
+            if (!node)
+                return nullptr;
+            Policy::onHit(m_list, &node->getValue());
+            return &node->getValue().value;
+        }
+
+        // The cached value without marking it or counting the lookup
+        const value_t* peek(const key_t& key) const {
+            const node_t* node = m_map.find(key);
+            return node ? &node->getValue().value : nullptr;
+        }
+
+        bool contains(const key_t& key) const {
+            return m_map.contains(key);
+        }
+
+        size_t size() const { return m_map.size(); }
+        bool empty() const { return m_map.empty(); }
+        size_t capacity() const { return m_capacity; }
+        // Sum of the charges of the cached entries
+        size_t usage() const { return m_usage; }
+
+        const CacheStats& stats() const { return m_stats; }
+        void reset_stats() { m_stats = CacheStats(); }
+
+
+        /********************** Utility **********************/
+
+        // Caches value under key, replacing any previous value, then evicts
+        // until the budget holds; true if the key was new. An entry charged
+        // more than capacity() is never cached (and replaces nothing: an
+        // old value under key is erased)
+        template <typename V>
+        bool put(const key_t& key, V&& value, size_t charge = 1) {
+            if (charge > m_capacity) {
+                erase(key);
+                return false;
+            }
+
+            auto result = m_map.try_emplace(key, std::forward<V>(value), charge);
+            slot_t& slot = result.first->getValue();
+            if (result.second) {
+                slot.key = &result.first->getKey();
+                m_list.push_front(&slot);
+                m_stats.insertions++;
+            }
+            else {
+                // try_emplace left value untouched, as in HashMap::insert_or_assign
+                slot.value = std::forward<V>(value);
+                m_usage -= slot.charge;
+                slot.charge = charge;
+                Policy::onHit(m_list, &slot);
+            }
+            m_usage += charge;
+            evictToFit(&slot);
+            return result.second;
+        }
+
+        bool erase(const key_t& key) {
+            node_t* node = m_map.find(key);
+            if (!node)
+                return false;
+            m_list.remove(&node->getValue());
+            m_usage -= node->getValue().charge;
+            return m_map.erase(key);
+        }
+
+        void clear() {
+            m_map.clear();
+            m_list.clear();
+            m_usage = 0;
+        }
+
+        // Evicts right away if the cache is over the new budget
+        void set_capacity(size_t capacity) {
+            m_capacity = capacity;
+            evictToFit(nullptr);
+        }
+
+        void set_eviction_callback(evict_fn onEvict) {
+            m_onEvict = std::move(onEvict);
+        }
+
+    private:
+        // Evicts policy victims until usage fits, never keep (the entry
+        // being put, whose charge alone fits)
+        void evictToFit(slot_t* keep) {
+            while (m_usage > m_capacity) {
+                slot_t* victim = Policy::victim(m_list);
+                if (victim == keep) {
+                    m_list.move_to_front(keep);
+                    continue;
+                }
+                evict(victim);
+            }
+        }
+
+        // A throwing callback leaves the entry cached and propagates
+        void evict(slot_t* victim) {
+            if (m_onEvict)
+                m_onEvict(*victim->key, victim->value);
+            m_list.remove(victim);
+            m_usage -= victim->charge;
+            m_stats.evictions++;
+            m_map.erase(*victim->key);
+        }
+
+        map_t m_map;
+        cache_detail::RecencyList<slot_t> m_list;   // front = newest
+        size_t m_capacity;
+        size_t m_usage;
+        CacheStats m_stats;
+        evict_fn m_onEvict;
+    };
+
+    template <typename key_t, typename value_t, typename Hash = std::hash<key_t>, typename KeyEqual = std::equal_to<key_t>>
+    using LruCache = BoundedCache<key_t, value_t, LruPolicy, Hash, KeyEqual>;
+
+    template <typename key_t, typename value_t, typename Hash = std::hash<key_t>, typename KeyEqual = std::equal_to<key_t>>
+    using ClockCache = BoundedCache<key_t, value_t, ClockPolicy, Hash, KeyEqual>;
+
+
+    /*
+    * Thread-safe cache made of independently locked BoundedCache shards,
+    * e.g. ShardedCache<LruCache<K, V>>.
+    *
+    * Shards are picked by ShardSelector, as in ConcurrentHashMap, and the
+    * capacity is split evenly between them, so eviction is per shard: an
+    * entry may be evicted while another shard still has room. get returns
+    * a copy of the value. With LruPolicy every get relinks and takes its
+    * shard's exclusive lock; with ClockPolicy gets take the shared lock, so
+    * hits on one shard run in parallel. The eviction callback runs under
+    * the shard's exclusive lock and must not call back into the cache
+    */
+    template <typename Cache>
+    class ShardedCache {
+    public:
+        using key_t = typename Cache::key_type;
+        using value_t = typename Cache::mapped_type;
+        using evict_fn = typename Cache::evict_fn;
+        static constexpr size_t CacheLine = 64;
+
+
+        /********************** Constructors **********************/
+
+        // shardCount == 0 picks 4 shards per hardware thread; the count is
+        // rounded up to a power of two
+        explicit ShardedCache(size_t capacity, size_t shardCount = 0, evict_fn onEvict = nullptr)
+            : m_selector(shardCount), m_shards(new Shard[m_selector.count()]) {
+            set_capacity(capacity);
+            if (onEvict)
+                set_eviction_callback(onEvict);
+        }
+
+        ShardedCache(const ShardedCache&) = delete;
+        ShardedCache& operator=(const ShardedCache&) = delete;
+
+
+        /********************** Getters **********************/
+
+        std::optional<value_t> get(const key_t& key) {
+            Shard& shard = shardFor(key);
+            if constexpr (Cache::policy::shared_hits) {
+                std::shared_lock<std::shared_mutex> lock(shard.lock);
+                const value_t* value = shard.cache.get_shared(key);
+                if (!value) {
+                    shard.misses.fetch_add(1, std::memory_order_relaxed);
+                    return std::nullopt;
+                }
+                shard.hits.fetch_add(1, std::memory_order_relaxed);
+                return *value;
+            }
+            else {
+                std::unique_lock<std::shared_mutex> lock(shard.lock);
+                const value_t* value = shard.cache.get(key);
+                if (!value)
+                    return std::nullopt;
+                return *value;
+            }
+        }
+
+        bool contains(const key_t& key) const {
+            const Shard& shard = shardFor(key);
+            std::shared_lock<std::shared_mutex> lock(shard.lock);
+            return shard.cache.contains(key);
+        }
+
+        size_t size() const {
+            return sum([](const Cache& cache) { return cache.size(); });
+        }
+        bool empty() const { return size() == 0; }
+        size_t usage() const {
+            return sum([](const Cache& cache) { return cache.usage(); });
+        }
+        size_t capacity() const {
+            return sum([](const Cache& cache) { return cache.capacity(); });
+        }
+        size_t shard_count() const { return m_selector.count(); }
+
+        // Totals over the shards; exact only while no other thread runs
+        CacheStats stats() const {
+            CacheStats total;
+            for (size_t i = 0; i < m_selector.count(); i++) {
+                std::shared_lock<std::shared_mutex> lock(m_shards[i].lock);
+                total += m_shards[i].cache.stats();
+                total.hits += m_shards[i].hits.load(std::memory_order_relaxed);
+                total.misses += m_shards[i].misses.load(std::memory_order_relaxed);
+            }
+            return total;
+        }
+
+        void reset_stats() {
+            forEachShard([](Shard& shard) {
+                shard.cache.reset_stats();
+                shard.hits.store(0, std::memory_order_relaxed);
+                shard.misses.store(0, std::memory_order_relaxed);
+            });
+        }
+
+
+        /********************** Utility **********************/
+
+        template <typename V>
+        bool put(const key_t& key, V&& value, size_t charge = 1) {
+            Shard& shard = shardFor(key);
+            std::unique_lock<std::shared_mutex> lock(shard.lock);
+            return shard.cache.put(key, std::forward<V>(value), charge);
+        }
+
+        bool erase(const key_t& key) {
+            Shard& shard = shardFor(key);
+            std::unique_lock<std::shared_mutex> lock(shard.lock);
+            return shard.cache.erase(key);
+        }
+
+        void clear() {
+            forEachShard([](Shard& shard) { shard.cache.clear(); });
+        }
+
+        // Total budget, split evenly (rounded up) over the shards
+        void set_capacity(size_t capacity) {
+            size_t perShard = (capacity + m_selector.count() - 1) / m_selector.count();
+            forEachShard([&](Shard& shard) { shard.cache.set_capacity(perShard); });
+        }
+
+        void set_eviction_callback(const evict_fn& onEvict) {
+            forEachShard([&](Shard& shard) { shard.cache.set_eviction_callback(onEvict); });
+        }
+
+    private:
+        // hits/misses count get_shared lookups, which leave the cache's own
+        // counters alone
+        struct alignas(CacheLine) Shard {
+            mutable std::shared_mutex lock;
+            Cache cache{ 0 };
+            std::atomic<uint64_t> hits{ 0 };
+            std::atomic<uint64_t> misses{ 0 };
+        };
+
+        size_t shardIndex(const key_t& key) const {
+            return m_selector(m_hash(key));
+        }
+
+        Shard& shardFor(const key_t& key) {
+            return m_shards[shardIndex(key)];
+        }
+        const Shard& shardFor(const key_t& key) const {
+            return m_shards[shardIndex(key)];
+        }
+
+        template <typename Fn>
+        void forEachShard(Fn&& fn) {
+            for (size_t i = 0; i < m_selector.count(); i++) {
+                std::unique_lock<std::shared_mutex> lock(m_shards[i].lock);
+                fn(m_shards[i]);
+            }
+        }
+
+        template <typename Fn>
+        size_t sum(Fn&& fn) const {
+            size_t total = 0;
+            for (size_t i = 0; i < m_selector.count(); i++) {
+                std::shared_lock<std::shared_mutex> lock(m_shards[i].lock);
+                total += fn(m_shards[i].cache);
+            }
+            return total;
+        }
+
+        ShardSelector m_selector;
+        typename Cache::hasher m_hash;
+        std::unique_ptr<Shard[]> m_shards;
+    };
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <vector>
+#include <new>
+#include <cstddef>
+
+
+namespace pSTL {
+    /*
+    * Slab allocator for fixed-size nodes.
+    *
+    * Memory comes in cache-line-aligned blocks of nodes_per_block slots.
+    * allocate() pops the free list, or bumps into the current block, or
+    * starts a new block; deallocate() pushes onto the free list, so erased
+    * nodes are recycled by the next insert without touching malloc.
+    * release() returns every block at once. Blocks are otherwise kept for
+    * the lifetime of the pool.
+    *
+    * allocate() hands out uninitialized storage for one T; callers
+    * placement-construct and destroy it themselves. Not thread-safe: a
+    * pool shared between containers must be used from one thread at a time
+    */
+    template <typename T>
+    class NodePool {
+    public:
+        static constexpr size_t CacheLine = 64;
+        static constexpr size_t DefaultBlockBytes = 16 * 1024;
+        static_assert(alignof(T) <= CacheLine, "NodePool: over-aligned node type");
+
+
+        /********************** Constructors **********************/
+
+        // nodesPerBlock == 0 picks as many nodes as fit in 16 KiB
+        explicit NodePool(size_t nodesPerBlock = 0)
+            : m_free(nullptr), m_cursor(nullptr), m_end(nullptr), m_live(0),
+              m_nodesPerBlock(nodesPerBlock ? nodesPerBlock : defaultNodesPerBlock()) {
+        }
+
+        NodePool(const NodePool&) = delete;
+        NodePool& operator=(const NodePool&) = delete;
+
+        ~NodePool() {
+            release();
+        }
+
+
+        /********************** Allocation **********************/
+
+        T* allocate() {
+            Slot* slot;
+            if (m_free) {
+                slot = m_free;
+                m_free = m_free->next;
+            }
+            else {
+                if (m_cursor == m_end)
+                    addBlock();
+                slot = m_cursor++;
+            }
+            m_live++;
+            return reinterpret_cast<T*>(slot->storage);
+        }
+
+        void deallocate(T* node) noexcept {
+            Slot* slot = reinterpret_cast<Slot*>(node);
+            slot->next = m_free;
+            m_free = slot;
+            m_live--;
+        }
+
+        // Frees all blocks. Any node still in use is invalidated
+        void release() noexcept {
+            for (Slot* block : m_blocks)
+                ::operator delete(block, std::align_val_t(CacheLine));
+            m_blocks.clear();
+            m_free = nullptr;
+            m_cursor = nullptr;
+            m_end = nullptr;
+            m_live = 0;
+        }
+
+
+        /********************** Getters **********************/
+
+        size_t live() const noexcept { return m_live; }
+        size_t capacity() const noexcept { return m_blocks.size() * m_nodesPerBlock; }
+        size_t block_count() const noexcept { return m_blocks.size(); }
+        size_t nodes_per_block() const noexcept { return m_nodesPerBlock; }
+
+    private:
+        union Slot {
+            Slot* next;
+            alignas(T) unsigned char storage[sizeof(T)];
+        };
+
+        static size_t defaultNodesPerBlock() noexcept {
+            size_t n = DefaultBlockBytes / sizeof(Slot);
+            return n ? n : 1;
+        }
+
+        void addBlock() {
+            // Room first so push_back cannot throw and leak the block;
+            // doubling keeps growth linear
+            if (m_blocks.size() == m_blocks.capacity())
+                m_blocks.reserve(2 * m_blocks.size() + 1);
+            Slot* block = static_cast<Slot*>(::operator new(m_nodesPerBlock * sizeof(Slot), std::align_val_t(CacheLine)));
+            m_blocks.push_back(block);
+            m_cursor = block;
+            m_end = block + m_nodesPerBlock;
+        }
+
+        Slot* m_free;       // recycled slots, linked through Slot::next
+        Slot* m_cursor;     // next never-used slot of the newest block
+        Slot* m_end;
+        size_t m_live;
+        size_t m_nodesPerBlock;
+        std::vector<Slot*> m_blocks;
+    };
+}
@@ -0,0 +1,433 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "HashMap.h"
+#include "Hashers.h"
+
+
+namespace pSTL {
+    // Stored entry of a perfect hash map; the accessors mirror Node so code
+    // written against HashMap::find reads the same
+    template <typename key_t, typename value_t>
+    struct PerfectEntry {
+        key_t key{};
+        value_t value{};
+
+        constexpr const key_t& getKey() const { return key; }
+        constexpr const value_t& getValue() const { return value; }
+    };
+
+    namespace phf_detail {
+        /*
+        * Hash-and-displace construction (CHD, with PTHash-style pilots),
+        * shared by PerfectHashMap and StaticPerfectHashMap and usable in
+        * constant expressions.
+        *
+        * Keys are split into buckets by their hash and every bucket gets a
+        * pilot: a key's slot among the n slots is its hash mixed with the
+        * bucket's pilot and reduced to [0, n). Each pilot value scatters the
+        * bucket's keys afresh, so buckets are placed largest first, while
+        * the table is still mostly empty, each taking the first pilot that
+        * puts all of its keys on free, distinct slots. A bucket that runs
+        * out of pilots restarts the build with the next seed.
+        *
+        * A lookup is one hash, one pilot read and one slot compare
+        */
+        constexpr size_t KeysPerBucket = 3;     // average bucket size aimed for; pilots cost 4 bytes per bucket
+        constexpr uint64_t MaxSeeds = 64;
+        constexpr size_t None = ~static_cast<size_t>(0);
+
+        enum class BuildResult { Ok, Failed, SameHash };
+
+        // Working arrays for build(), sized as noted
+        struct Scratch {
+            size_t* bucketStart;    // buckets + 1
+            size_t* members;        // n
+            uint64_t* memberHashes; // n, hashes[members[i]], so a bucket's hashes are contiguous
+            size_t* order;          // buckets
+            size_t* trial;          // n
+            uint64_t* taken;        // takenWords(n)
+        };
+
+        // Occupied-slot bitmap words: the search mostly tests slots, and a
+        // bit per slot stays in cache where slotKey would not
+        constexpr size_t takenWords(size_t n) {
+            return n / 64 + 1;
+        }
+
+        // Power of two near n / KeysPerBucket
+        constexpr size_t bucketCount(size_t n) {
+            size_t buckets = 1;
+            while (buckets * KeysPerBucket < n) buckets <<= 1;
+            return buckets;
+        }
+
+        constexpr size_t bucketOf(uint64_t hash, size_t mask) {
+            return static_cast<size_t>(hash >> 32) & mask;
+        }
+
+        // Multiply-shift reduction of the mixed hash to [0, n), n < 2^32
+        constexpr size_t slotOf(uint64_t hash, uint64_t seed, uint32_t pilot, size_t n) {
+            uint64_t x = hash_detail::splitmix(hash ^ seed ^ (pilot * 0x9E3779B97F4A7C15ull));
+            return static_cast<size_t>(((x >> 32) * n) >> 32);
+        }
+
+        // One attempt with the given seed. On success slotKey[s] is the
+        // index of the key placed in slot s. SameHash reports two keys
+        // with equal hashes in clash[0], clash[1]: no seed can separate them
+        constexpr BuildResult build(const uint64_t* hashes, size_t n, size_t mask, uint64_t seed,
+                                    uint32_t* pilots, size_t* slotKey, Scratch s, size_t* clash) {
+            size_t buckets = mask + 1;
+            for (size_t b = 0; b <= buckets; b++)
+                s.bucketStart[b] = 0;
+            for (size_t i = 0; i < n; i++)
+                s.bucketStart[bucketOf(hashes[i], mask) + 1]++;
+
+            size_t maxSize = 0;
+            for (size_t b = 0; b < buckets; b++) {
+                maxSize = s.bucketStart[b + 1] > maxSize ? s.bucketStart[b + 1] : maxSize;
+                s.bucketStart[b + 1] += s.bucketStart[b];
+            }
+
+            // Group key indices by bucket, using order as the fill cursors
+            for (size_t b = 0; b < buckets; b++)
+                s.order[b] = s.bucketStart[b];
+            for (size_t i = 0; i < n; i++) {
+                size_t at = s.order[bucketOf(hashes[i], mask)]++;
+                s.members[at] = i;
+                s.memberHashes[at] = hashes[i];
+            }
+
+            for (size_t b = 0; b < buckets; b++) {
+                for (size_t i = s.bucketStart[b]; i < s.bucketStart[b + 1]; i++) {
+                    for (size_t j = i + 1; j < s.bucketStart[b + 1]; j++) {
+                        if (s.memberHashes[i] == s.memberHashes[j]) {
+                            clash[0] = s.members[i];
+                            clash[1] = s.members[j];
+                            return BuildResult::SameHash;
+                        }
+                    }
+                }
+            }
+
+            // Non-empty buckets by size, largest first (counting sort, trial as the counts)
+            for (size_t k = 0; k < maxSize; k++)
+                s.trial[k] = 0;
+            for (size_t b = 0; b < buckets; b++)
+                if (size_t size = s.bucketStart[b + 1] - s.bucketStart[b]) s.trial[size - 1]++;
+            size_t placed = 0;
+            for (size_t k = maxSize; k-- > 0;) {
+                size_t count = s.trial[k];
+                s.trial[k] = placed;
+                placed += count;
+            }
+            for (size_t b = 0; b < buckets; b++)
+                if (size_t size = s.bucketStart[b + 1] - s.bucketStart[b]) s.order[s.trial[size - 1]++] = b;
+
+            for (size_t w = 0; w < takenWords(n); w++)
+                s.taken[w] = 0;
+            for (size_t b = 0; b < buckets; b++)
+                pilots[b] = 0;
+
+            // The last free slot takes about n tries to hit; far more means a bad seed
+            uint64_t maxPilot = 16 * static_cast<uint64_t>(n) + 1024;
+            if (maxPilot > 0xFFFFFFFFull)
+                maxPilot = 0xFFFFFFFFull;
+            for (size_t o = 0; o < placed; o++) {
+                size_t b = s.order[o];
+                size_t first = s.bucketStart[b], size = s.bucketStart[b + 1] - first;
+                bool done = false;
+                for (uint64_t pilot = 0; pilot < maxPilot && !done; pilot++) {
+                    size_t k = 0;
+                    for (; k < size; k++) {
+                        size_t slot = slotOf(s.memberHashes[first + k], seed, static_cast<uint32_t>(pilot), n);
+                        if (s.taken[slot / 64] & (uint64_t(1) << (slot % 64)))
+                            break;
+                        size_t j = 0;
+                        while (j < k && s.trial[j] != slot) j++;
+                        if (j < k)
+                            break;
+                        s.trial[k] = slot;
+                    }
+                    if (k == size) {
+                        for (k = 0; k < size; k++) {
+                            s.taken[s.trial[k] / 64] |= uint64_t(1) << (s.trial[k] % 64);
+                            slotKey[s.trial[k]] = s.members[first + k];
+                        }
+                        pilots[b] = static_cast<uint32_t>(pilot);
+                        done = true;
+                    }
+                }
+                if (!done)
+                    return BuildResult::Failed;
+            }
+            return BuildResult::Ok;
+        }
+
+        // build() over successive seeds; seed receives the one that worked
+        constexpr BuildResult construct(const uint64_t* hashes, size_t n, size_t mask, uint64_t& seed,
+                                        uint32_t* pilots, size_t* slotKey, Scratch s, size_t* clash) {
+            for (uint64_t i = 0; i < MaxSeeds; i++) {
+                seed = hash_detail::splitmix(i);
+                BuildResult result = build(hashes, n, mask, seed, pilots, slotKey, s, clash);
+                if (result != BuildResult::Failed)
+                    return result;
+            }
+            return BuildResult::Failed;
+        }
+    }
+
+    /*
+    * Immutable hash map over a fixed key set, with a collision-free
+    * (perfect) and minimal table: n keys occupy exactly n slots, and a
+    * lookup reads one pilot and compares one slot, hit or miss.
+    *
+    * Built from an initializer list, an iterator range or an existing
+    * HashMap (whose hasher and key equality it adopts); construction
+    * costs a few hashes per key and throws std::invalid_argument on a
+    * duplicate key. index_of gives each key a dense id in [0, size()).
+    * Hash and KeyEqual may be transparent, as for HashMap. For key sets
+    * known at compile time see StaticPerfectHashMap
+    */
+    template <typename key_t, typename value_t, typename Hash = std::hash<key_t>, typename KeyEqual = std::equal_to<key_t>>
+    class PerfectHashMap {
+        template <typename F, typename = void>
+        struct is_transparent : std::false_type {};
+        template <typename F>
+        struct is_transparent<F, std::void_t<typename F::is_transparent>> : std::true_type {};
+
+        template <typename H, typename E>
+        static constexpr bool transparent_v = is_transparent<H>::value && is_transparent<E>::value;
+
+    public:
+        using entry_t = PerfectEntry<key_t, value_t>;
+        using const_iterator = const entry_t*;
+        using hasher = Hash;
+        using key_equal = KeyEqual;
+
+        static constexpr size_t npos = phf_detail::None;
+
+
+        /********************** Constructors **********************/
+
+        PerfectHashMap()
+            : m_pilots(1), m_seed(0), m_mask(0) {
+        }
+
+        PerfectHashMap(std::initializer_list<std::pair<key_t, value_t>> initList, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual())
+            : PerfectHashMap(initList.begin(), initList.end(), hash, equal) {
+        }
+
+        // Entries are pairs (anything with first and second)
+        template <typename InputIt>
+        PerfectHashMap(InputIt first, InputIt last, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual())
+            : m_seed(0), m_mask(0), m_hash(hash), m_equal(equal) {
+            std::vector<entry_t> entries;
+            for (; first != last; ++first)
+                entries.push_back(entry_t{ first->first, first->second });
+            build(std::move(entries));
+        }
+
+        explicit PerfectHashMap(const HashMap<key_t, value_t, Hash, KeyEqual>& map)
+            : m_seed(0), m_mask(0), m_hash(map.hash_function()), m_equal(map.key_eq()) {
+            std::vector<entry_t> entries;
+            entries.reserve(map.size());
+            map.for_each([&](const key_t& key, const value_t& value) {
+                entries.push_back(entry_t{ key, value });
+            });
+            build(std::move(entries));
+        }
+
+
+        /********************** Getters **********************/
+
+        const entry_t* find(const key_t& key) const {
+            return findImpl(key);
+        }
+        template <typename K, typename H = Hash, typename E = KeyEqual, typename = std::enable_if_t<transparent_v<H, E>>>
+        const entry_t* find(const K& key) const {
+            return findImpl(key);
+        }
+
+        const value_t& at(const key_t& key) const {
+            const entry_t* entry = find(key);
+            if (!entry)
+                throw std::out_of_range("Key not found");
+            return entry->value;
+        }
+
+        bool contains(const key_t& key) const {
+            return find(key) != nullptr;
+        }
+
+        // Slot of key in [0, size()), or npos if absent
+        size_t index_of(const key_t& key) const {
+            const entry_t* entry = find(key);
+            return entry ? static_cast<size_t>(entry - m_entries.data()) : npos;
+        }
+
+        size_t size() const { return m_entries.size(); }
+        bool empty() const { return m_entries.empty(); }
+
+        hasher hash_function() const { return m_hash; }
+        key_equal key_eq() const { return m_equal; }
+
+
+        /********************** Iterators **********************/
+
+        // Entries in slot order, so begin()[index_of(key)] is key's entry
+        const_iterator begin() const { return m_entries.data(); }
+        const_iterator end() const { return m_entries.data() + m_entries.size(); }
+
+    private:
+        template <typename K>
+        const entry_t* findImpl(const K& key) const {
+            if (m_entries.empty())
+                return nullptr;
+            uint64_t hash = hash_detail::finish<Hash>(m_hash(key));
+            const entry_t& entry = m_entries[phf_detail::slotOf(hash, m_seed, m_pilots[phf_detail::bucketOf(hash, m_mask)], m_entries.size())];
+            return m_equal(entry.key, key) ? &entry : nullptr;
+        }
+
+        void build(std::vector<entry_t> entries) {
+            size_t n = entries.size();
+            size_t buckets = phf_detail::bucketCount(n);
+            m_mask = buckets - 1;
+            m_pilots.assign(buckets, 0);
+            if (n == 0)
+                return;
+            if (static_cast<uint64_t>(n) > 0xFFFFFFFFull)
+                throw std::length_error("PerfectHashMap: more than 2^32 - 1 keys");
+
+            std::vector<uint64_t> hashes(n);
+            for (size_t i = 0; i < n; i++)
+                hashes[i] = hash_detail::finish<Hash>(m_hash(entries[i].key));
+
+            std::vector<size_t> bucketStart(buckets + 1), members(n), order(buckets), trial(n), slotKey(n);
+            std::vector<uint64_t> memberHashes(n), taken(phf_detail::takenWords(n));
+            phf_detail::Scratch scratch{ bucketStart.data(), members.data(), memberHashes.data(), order.data(), trial.data(), taken.data() };
+            size_t clash[2] = {};
+            phf_detail::BuildResult result = phf_detail::construct(hashes.data(), n, m_mask, m_seed, m_pilots.data(), slotKey.data(), scratch, clash);
+            if (result == phf_detail::BuildResult::SameHash) {
+                if (m_equal(entries[clash[0]].key, entries[clash[1]].key))
+                    throw std::invalid_argument("PerfectHashMap: duplicate key");
+                throw std::runtime_error("PerfectHashMap: two keys have the same hash");
+            }
+            if (result != phf_detail::BuildResult::Ok)
+                throw std::runtime_error("PerfectHashMap: construction failed");
+
+            m_entries.reserve(n);
+            for (size_t slot = 0; slot < n; slot++)
+                m_entries.push_back(std::move(entries[slotKey[slot]]));
+        }
+
+        std::vector<entry_t> m_entries;                 // one per key, in slot order
+        std::vector<uint32_t> m_pilots;                 // one per bucket
+        uint64_t m_seed;
+        size_t m_mask;                                  // bucket count - 1
+        Hash m_hash;
+        KeyEqual m_equal;
+    };
+
+    /*
+    * PerfectHashMap for a key set known at compile time: the table is
+    * built by a constexpr constructor, so a constexpr instance costs
+    * nothing at startup and can be queried in constant expressions.
+    * Storage is two std::arrays sized by N.
+    *
+    * Hash must be usable in constant expressions (ConstexprHash by
+    * default), and key_t/value_t must be literal types, e.g.
+    * std::string_view, integers or enums. Create with
+    * make_perfect_hash_map, which deduces N from the braced list. A
+    * duplicate key fails the constant evaluation
+    */
+    template <typename key_t, typename value_t, size_t N, typename Hash = ConstexprHash, typename KeyEqual = std::equal_to<>>
+    class StaticPerfectHashMap {
+        static_assert(N > 0, "StaticPerfectHashMap: needs at least one entry");
+
+    public:
+        using entry_t = PerfectEntry<key_t, value_t>;
+        using const_iterator = const entry_t*;
+
+        static constexpr size_t npos = phf_detail::None;
+        static constexpr size_t Buckets = phf_detail::bucketCount(N);
+
+
+        /********************** Constructors **********************/
+
+        constexpr explicit StaticPerfectHashMap(const std::pair<key_t, value_t> (&entries)[N])
+            : m_entries{}, m_pilots{}, m_seed(0), m_hash{}, m_equal{} {
+            std::array<uint64_t, N> hashes{};
+            for (size_t i = 0; i < N; i++)
+                hashes[i] = hash_detail::finish<Hash>(m_hash(entries[i].first));
+
+            std::array<size_t, Buckets + 1> bucketStart{};
+            std::array<size_t, Buckets> order{};
+            std::array<size_t, N> members{}, trial{}, slotKey{};
+            std::array<uint64_t, N> memberHashes{};
+            std::array<uint64_t, phf_detail::takenWords(N)> taken{};
+            size_t clash[2] = {};
+            phf_detail::BuildResult result = phf_detail::construct(hashes.data(), N, Buckets - 1, m_seed, m_pilots.data(), slotKey.data(),
+                phf_detail::Scratch{ bucketStart.data(), members.data(), memberHashes.data(), order.data(), trial.data(), taken.data() }, clash);
+            if (result != phf_detail::BuildResult::Ok)
+                throw std::invalid_argument("StaticPerfectHashMap: duplicate key or hash collision");
+
+            for (size_t slot = 0; slot < N; slot++)
+                m_entries[slot] = entry_t{ entries[slotKey[slot]].first, entries[slotKey[slot]].second };
+        }
+
+
+        /********************** Getters **********************/
+
+        constexpr const entry_t* find(const key_t& key) const {
+            uint64_t hash = hash_detail::finish<Hash>(m_hash(key));
+            const entry_t& entry = m_entries[phf_detail::slotOf(hash, m_seed, m_pilots[phf_detail::bucketOf(hash, Buckets - 1)], N)];
+            return m_equal(entry.key, key) ? &entry : nullptr;
+        }
+
+        constexpr const value_t& at(const key_t& key) const {
+            const entry_t* entry = find(key);
+            if (!entry)
+                throw std::out_of_range("Key not found");
+            return entry->value;
+        }
+
+        constexpr bool contains(const key_t& key) const {
+            return find(key) != nullptr;
+        }
+
+        constexpr size_t index_of(const key_t& key) const {
+            const entry_t* entry = find(key);
+            return entry ? static_cast<size_t>(entry - m_entries.data()) : npos;
+        }
+
+        constexpr size_t size() const { return N; }
+        constexpr bool empty() const { return false; }
+
+
+        /********************** Iterators **********************/
+
+        constexpr const_iterator begin() const { return m_entries.data(); }
+        constexpr const_iterator end() const { return m_entries.data() + N; }
+
+    private:
+        std::array<entry_t, N> m_entries;
+        std::array<uint32_t, Buckets> m_pilots;
+        uint64_t m_seed;
+        Hash m_hash;
+        KeyEqual m_equal;
+    };
+
+    template <typename key_t, typename value_t, typename Hash = ConstexprHash, typename KeyEqual = std::equal_to<>, size_t N>
+    constexpr StaticPerfectHashMap<key_t, value_t, N, Hash, KeyEqual> make_perfect_hash_map(const std::pair<key_t, value_t> (&entries)[N]) {
+        return StaticPerfectHashMap<key_t, value_t, N, Hash, KeyEqual>(entries);
+    }
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+
+namespace pSTL {
+    namespace snapshot {
+        /*
+        * Binary image written by HashMap::save and mapped by FrozenHashMap.
+        *
+        * Layout: a 64-byte Header, then count Entry records grouped by
+        * bucket, then (8-byte aligned) bucketCount + 1 uint64 offsets.
+        * Bucket b holds the entries [offsets[b], offsets[b + 1]) of the
+        * keys whose hash masked by bucketCount - 1 is b. Nothing is stored
+        * per entry besides key and value, so a lookup is one offset pair
+        * and a short contiguous scan. Offsets come last so the writer can
+        * stream entries while counting them.
+        *
+        * Keys and values are stored as raw bytes: the image is only valid
+        * for the same key/value types, the same hash function and the same
+        * byte order, which the header records and FrozenHashMap checks
+        */
+        constexpr char Magic[8] = { 'p', 'S', 'T', 'L', 'H', 'M', 'A', 'P' };
+        constexpr uint32_t Version = 1;
+        constexpr uint32_t ByteOrderMark = 0x01020304;  // reads back differently on the other byte order
+        constexpr size_t HeaderSize = 64;
+        constexpr size_t EntriesPerBucket = 2;          // average chain length aimed for
+
+        struct Header {
+            char magic[8];
+            uint32_t version;
+            uint32_t byteOrder;
+            uint32_t keySize;
+            uint32_t valueSize;
+            uint32_t entrySize;
+            uint32_t entryAlign;
+            uint64_t count;
+            uint64_t bucketCount;       // power of two
+            uint64_t entriesOffset;     // byte offset of the first Entry; the offsets follow the last one
+            uint64_t hashCheck;         // hashCheck() of the first and last entries, to catch a different hasher on load
+        };
+        static_assert(sizeof(Header) == HeaderSize, "snapshot::Header must stay 64 bytes");
+
+        // One stored entry; the accessors mirror Node so code written
+        // against HashMap::find reads the same
+        template <typename key_t, typename value_t>
+        struct Entry {
+            key_t key;
+            value_t value;
+
+            const key_t& getKey() const { return key; }
+            const value_t& getValue() const { return value; }
+        };
+
+        // Two keys, so a key some hashers agree on (0 often hashes to 0) cannot pass alone
+        inline uint64_t hashCheck(uint64_t firstHash, uint64_t lastHash) {
+            return firstHash ^ (lastHash * 0x9E3779B97F4A7C15ull + 1);
+        }
+
+        template <typename key_t, typename value_t>
+        constexpr size_t entriesOffset() {
+            return alignof(Entry<key_t, value_t>) > HeaderSize ? alignof(Entry<key_t, value_t>) : HeaderSize;
+        }
+
+        template <typename key_t, typename value_t>
+        constexpr uint64_t offsetsOffset(uint64_t count) {
+            return (entriesOffset<key_t, value_t>() + count * sizeof(Entry<key_t, value_t>) + 7) & ~static_cast<uint64_t>(7);
+        }
+
+        // Power of two near count / EntriesPerBucket, at most maxBuckets
+        // (itself a power of two)
+        inline uint64_t bucketCountFor(size_t count, size_t maxBuckets) {
+            uint64_t buckets = 1;
+            while (buckets * EntriesPerBucket < count && buckets < maxBuckets) buckets <<= 1;
+            return buckets;
+        }
+
+        // Writes to path + ".tmp" and renames it over path on commit(), so
+        // a process still mapping the old image keeps a valid mapping
+        // (truncating a mapped file in place would fault its readers).
+        // Dropped without commit(), the partial file is removed
+        class Writer {
+        public:
+            explicit Writer(const std::string& path)
+                : m_path(path), m_tmpPath(path + ".tmp"), m_file(std::fopen(m_tmpPath.c_str(), "wb")), m_written(0) {
+                if (!m_file) throw std::runtime_error("snapshot: cannot create " + m_tmpPath);
+            }
+
+            Writer(const Writer&) = delete;
+            Writer& operator=(const Writer&) = delete;
+
+            ~Writer() {
+                if (m_file) {
+                    std::fclose(m_file);
+                    std::remove(m_tmpPath.c_str());
+                }
+            }
+
+            void write(const void* data, size_t bytes) {
+                if (bytes && std::fwrite(data, 1, bytes, m_file) != bytes) throw std::runtime_error("snapshot: write failed");
+                m_written += bytes;
+            }
+
+            // Zero-fills up to the absolute file offset
+            void padTo(size_t offset) {
+                static const char zeros[64] = {};
+                while (m_written < offset) write(zeros, std::min(sizeof(zeros), offset - m_written));
+            }
+
+            size_t written() const { return m_written; }
+
+            // Overwrites the header once everything after it is written
+            void rewriteHeader(const Header& header) {
+                if (std::fflush(m_file) != 0 || std::fseek(m_file, 0, SEEK_SET) != 0
+                    || std::fwrite(&header, 1, sizeof(header), m_file) != sizeof(header))
+                    throw std::runtime_error("snapshot: write failed");
+            }
+
+            void commit() {
+                std::FILE* file = m_file;
+                m_file = nullptr;
+                if (std::fclose(file) != 0) {
+                    std::remove(m_tmpPath.c_str());
+                    throw std::runtime_error("snapshot: write failed");
+                }
+#if defined(_WIN32)
+                std::remove(m_path.c_str());    // rename does not replace on Windows
+#endif
+                if (std::rename(m_tmpPath.c_str(), m_path.c_str()) != 0) {
+                    std::remove(m_tmpPath.c_str());
+                    throw std::runtime_error("snapshot: cannot replace " + m_path);
+                }
+            }
+
+        private:
+            std::string m_path;
+            std::string m_tmpPath;
+            std::FILE* m_file;
+            size_t m_written;
+        };
+    }
+}
@@ -0,0 +1,391 @@
+#pragma once
+
+#include <stdexcept>
+#include <functional>
+#include <initializer_list>
+#include <utility>
+#include <new>
+#include <cstdint>
+#include <cstring>
+
+#if !defined(PSTL_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define PSTL_SWISS_SSE2 1
+#include <emmintrin.h>
+#endif
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+#include "FlatHashMap.h"
+
+
+namespace pSTL {
+    namespace swiss {
+        // Control byte values. Full slots hold the low 7 hash bits (0..127),
+        // so "not full" is exactly "high bit set"
+        constexpr uint8_t Empty = 0x80;
+        constexpr uint8_t Deleted = 0xFE;
+        constexpr size_t GroupSize = 16;
+
+        inline unsigned countTrailingZeros(uint32_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return index;
+#else
+            return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+        }
+
+        // 16 control bytes; each match returns a bitmask with bit i set for slot i
+        class Group {
+        public:
+#if defined(PSTL_SWISS_SSE2)
+            explicit Group(const uint8_t* ctrl)
+                : m_ctrl(_mm_load_si128(reinterpret_cast<const __m128i*>(ctrl))) {
+            }
+
+            uint32_t match(uint8_t h2) const {
+                return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(m_ctrl, _mm_set1_epi8(static_cast<char>(h2)))));
+            }
+            uint32_t matchEmpty() const {
+                return match(Empty);
+            }
+            uint32_t matchEmptyOrDeleted() const {
+                return static_cast<uint32_t>(_mm_movemask_epi8(m_ctrl));
+            }
+
+        private:
+            __m128i m_ctrl;
+#else
+            explicit Group(const uint8_t* ctrl) {
+                std::memcpy(m_ctrl, ctrl, GroupSize);
+            }
+
+            uint32_t match(uint8_t h2) const {
+                uint32_t mask = 0;
+                for (size_t i = 0; i < GroupSize; i++) mask |= static_cast<uint32_t>(m_ctrl[i] == h2) << i;
+                return mask;
+            }
+            uint32_t matchEmpty() const {
+                return match(Empty);
+            }
+            uint32_t matchEmptyOrDeleted() const {
+                uint32_t mask = 0;
+                for (size_t i = 0; i < GroupSize; i++) mask |= static_cast<uint32_t>(m_ctrl[i] >> 7) << i;
+                return mask;
+            }
+
+        private:
+            uint8_t m_ctrl[GroupSize];
+#endif
+        };
+    }
+
+    /*
+    * Swiss-table style open-addressing map with the HashMap interface.
+    *
+    * Next to the slot array sits one control byte per slot: Empty, Deleted,
+    * or the low 7 bits (H2) of the key's hash. Slots are probed a group of
+    * 16 at a time: one SSE2 compare + movemask yields every slot whose H2
+    * matches, and only those keys are compared. A lookup ends at the first
+    * group containing an Empty byte, so misses usually read 16 control
+    * bytes and no key memory at all. Groups are visited in triangular
+    * order, which covers every group of a power-of-two table.
+    *
+    * Erase leaves a Deleted tombstone only when the group is full (a probe
+    * may have passed through it); tombstones count toward the 7/8 load
+    * limit and are purged by the next rehash. Without SSE2, or with
+    * PSTL_NO_SIMD defined, groups are matched with portable loops.
+    * Inserting or erasing invalidates pointers returned by find
+    */
+    template <typename key_t, typename value_t>
+    class SwissHashMap {
+    public:
+        using slot_t = FlatSlot<key_t, value_t>;
+
+
+        /********************** Constructors **********************/
+
+        // capacity: number of entries that fit before the first rehash
+        explicit SwissHashMap(size_t capacity = 10)
+            : SwissHashMap(SlotCount{ slotsFor(capacity) }) {
+        }
+
+        SwissHashMap(std::initializer_list<std::pair<key_t, value_t>> initList)
+            : SwissHashMap(initList.size()) {
+            for (const auto& p : initList) {
+                insert(p.first, p.second);
+            }
+        }
+
+        ~SwissHashMap() {
+            clear();
+            deallocate();
+        }
+
+        // Delegates, and marks each slot full only once it is built, so a
+        // throwing copy is cleaned up by the destructor
+        SwissHashMap(const SwissHashMap& other)
+            : SwissHashMap(SlotCount{ other.m_capacity }) {
+            for (size_t i = 0; i < m_capacity; i++) {
+                if (isFull(other.m_ctrl[i])) {
+                    ::new (static_cast<void*>(m_slots + i)) slot_t(other.m_slots[i]);
+                    m_size++;
+                }
+                m_ctrl[i] = other.m_ctrl[i];
+            }
+            m_deleted = other.m_deleted;
+        }
+
+        SwissHashMap(SwissHashMap&& other) noexcept
+            : m_ctrl(other.m_ctrl), m_slots(other.m_slots), m_capacity(other.m_capacity), m_size(other.m_size), m_deleted(other.m_deleted) {
+            other.m_ctrl = nullptr;
+            other.m_slots = nullptr;
+            other.m_capacity = 0;
+            other.m_size = 0;
+            other.m_deleted = 0;
+        }
+
+        SwissHashMap& operator=(const SwissHashMap& other) {
+            if (this == &other)
+                return *this;
+
+            SwissHashMap temp = other;
+            swap(temp);
+            return *this;
+        }
+
+        SwissHashMap& operator=(SwissHashMap&& other) noexcept {
+            if (this == &other)
+                return *this;
+
+            clear();
+            deallocate();
+            swap(other);
+            return *this;
+        }
+
+
+        /********************** Getters **********************/
+
+        value_t& operator[](const key_t& key) {
+            slot_t* slot = find(key);
+            if (slot)
+                return slot->getValue();
+
+            size_t index = insertNew(key, value_t{}); // may rehash, read m_slots after
+            return m_slots[index].getValue();
+        }
+
+        value_t& at(const key_t& key) {
+            slot_t* slot = find(key);
+            if (!slot)
+                throw std::out_of_range("Key not found");
+            return slot->getValue();
+        }
+
+        size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+
+
+        /********************** Utility **********************/
+
+        void insert(const key_t& key, const value_t& value) {
+            slot_t* slot = find(key);
+            if (slot) {
+                slot->getValue() = value;
+                return;
+            }
+            insertNew(key, value);
+        }
+
+        bool erase(const key_t& key) {
+            size_t index = indexOf(key);
+            if (index == npos)
+                return false;
+
+            m_slots[index].~slot_t();
+            m_size--;
+
+            const uint8_t* group = m_ctrl + (index & ~(swiss::GroupSize - 1));
+            if (swiss::Group(group).matchEmpty()) {
+                m_ctrl[index] = swiss::Empty;
+            }
+            else {
+                m_ctrl[index] = swiss::Deleted;
+                m_deleted++;
+            }
+            return true;
+        }
+
+        // Makes room for newCapacity entries without further rehashing
+        void reserve(size_t newCapacity) {
+            size_t slots = slotsFor(newCapacity);
+            if (slots > m_capacity)
+                rehash(slots);
+        }
+
+        slot_t* find(const key_t& key) {
+            size_t index = indexOf(key);
+            return index == npos ? nullptr : m_slots + index;
+        }
+
+        void grow() {
+            rehash(m_capacity ? m_capacity * 2 : swiss::GroupSize);
+        }
+
+        void swap(SwissHashMap& other) noexcept {
+            std::swap(m_ctrl, other.m_ctrl);
+            std::swap(m_slots, other.m_slots);
+            std::swap(m_capacity, other.m_capacity);
+            std::swap(m_size, other.m_size);
+            std::swap(m_deleted, other.m_deleted);
+        }
+
+        void clear() {
+            for (size_t i = 0; i < m_capacity; i++) {
+                if (isFull(m_ctrl[i]))
+                    m_slots[i].~slot_t();
+            }
+            if (m_capacity)
+                std::memset(m_ctrl, swiss::Empty, m_capacity);
+            m_size = 0;
+            m_deleted = 0;
+        }
+
+    private:
+        struct SlotCount { size_t slots; };
+
+        explicit SwissHashMap(SlotCount count)
+            : m_ctrl(nullptr), m_slots(nullptr), m_capacity(0), m_size(0), m_deleted(0) {
+            if (count.slots)
+                allocate(count.slots);
+        }
+
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        static bool isFull(uint8_t ctrl) noexcept { return (ctrl & 0x80) == 0; }
+
+        size_t groupMask() const noexcept { return m_capacity / swiss::GroupSize - 1; }
+        size_t maxLoad() const noexcept { return m_capacity - m_capacity / 8; }
+
+        // Slot count (power of two, at least one group) keeping count entries under 7/8 load
+        static size_t slotsFor(size_t count) noexcept {
+            size_t needed = count + count / 7 + 1;
+            size_t slots = swiss::GroupSize;
+            while (slots < needed) slots <<= 1;
+            return slots;
+        }
+
+        // std::hash is the identity for integers; mix so both H1 and H2 get entropy
+        static uint64_t hashOf(const key_t& key) noexcept {
+            uint64_t h = static_cast<uint64_t>(std::hash<key_t>{}(key));
+            h ^= h >> 33;
+            h *= 0xFF51AFD7ED558CCDull;
+            h ^= h >> 33;
+            return h;
+        }
+
+        size_t indexOf(const key_t& key) const {
+            if (m_capacity == 0)
+                return npos; // moved-from
+
+            uint64_t h = hashOf(key);
+            uint8_t h2 = static_cast<uint8_t>(h & 0x7F);
+            size_t group = static_cast<size_t>(h >> 7) & groupMask();
+
+            for (size_t step = 1;; step++) {
+                size_t base = group * swiss::GroupSize;
+                swiss::Group g(m_ctrl + base);
+                for (uint32_t mask = g.match(h2); mask; mask &= mask - 1) {
+                    size_t index = base + swiss::countTrailingZeros(mask);
+                    if (m_slots[index].getKey() == key)
+                        return index;
+                }
+                if (g.matchEmpty())
+                    return npos;
+                group = (group + step) & groupMask();
+            }
+        }
+
+        // First Empty or Deleted slot on h's probe sequence
+        size_t findFree(uint64_t h) const noexcept {
+            size_t group = static_cast<size_t>(h >> 7) & groupMask();
+            for (size_t step = 1;; step++) {
+                size_t base = group * swiss::GroupSize;
+                uint32_t mask = swiss::Group(m_ctrl + base).matchEmptyOrDeleted();
+                if (mask)
+                    return base + swiss::countTrailingZeros(mask);
+                group = (group + step) & groupMask();
+            }
+        }
+
+        // Inserts a key known to be absent; returns its slot
+        size_t insertNew(const key_t& key, const value_t& value) {
+            if (m_size + m_deleted + 1 > maxLoad()) {
+                // Mostly tombstones: purge them at the same size instead of growing
+                if (m_capacity && m_size + 1 <= maxLoad() / 2)
+                    rehash(m_capacity);
+                else
+                    grow();
+            }
+
+            uint64_t h = hashOf(key);
+            size_t index = findFree(h);
+            ::new (static_cast<void*>(m_slots + index)) slot_t(key, value);
+            if (m_ctrl[index] == swiss::Deleted)
+                m_deleted--;
+            m_ctrl[index] = static_cast<uint8_t>(h & 0x7F);
+            m_size++;
+            return index;
+        }
+
+        // Builds the new table on the side and swaps it in at the end, so a
+        // throw (allocation or a throwing copy) leaves the map as it was.
+        // Entries whose move may throw are copied
+        void rehash(size_t newCapacity) {
+            SwissHashMap fresh(SlotCount{ newCapacity });
+            for (size_t i = 0; i < m_capacity; i++) {
+                if (isFull(m_ctrl[i])) {
+                    uint64_t h = hashOf(m_slots[i].getKey());
+                    size_t index = fresh.findFree(h);
+                    ::new (static_cast<void*>(fresh.m_slots + index)) slot_t(std::move_if_noexcept(m_slots[i]));
+                    fresh.m_ctrl[index] = static_cast<uint8_t>(h & 0x7F);
+                    fresh.m_size++;
+                }
+            }
+            swap(fresh);    // fresh destroys the old, moved-from entries
+        }
+
+        void allocate(size_t slots) {
+            uint8_t* newCtrl = static_cast<uint8_t*>(::operator new(slots, std::align_val_t(swiss::GroupSize)));
+            slot_t* newSlots;
+            try {
+                newSlots = static_cast<slot_t*>(::operator new(slots * sizeof(slot_t), std::align_val_t(alignof(slot_t))));
+            }
+            catch (...) {
+                ::operator delete(newCtrl, std::align_val_t(swiss::GroupSize));
+                throw;
+            }
+            std::memset(newCtrl, swiss::Empty, slots);
+            m_ctrl = newCtrl;
+            m_slots = newSlots;
+            m_capacity = slots;
+        }
+
+        void deallocate() noexcept {
+            ::operator delete(m_slots, std::align_val_t(alignof(slot_t)));
+            ::operator delete(m_ctrl, std::align_val_t(swiss::GroupSize));
+            m_ctrl = nullptr;
+            m_slots = nullptr;
+            m_capacity = 0;
+        }
+
+        uint8_t* m_ctrl;    // one control byte per slot, 16-byte aligned
+        slot_t* m_slots;    // uninitialized storage; slot i is live iff m_ctrl[i] is full
+        size_t m_capacity;  // number of slots, a power of two >= 16
+        size_t m_size;
+        size_t m_deleted;   // tombstones
+    };
+}
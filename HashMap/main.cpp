@@ -2,11 +2,702 @@
 #include <iostream>
 #include <stdexcept>
 #include <string>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <random>
+#include <algorithm>
+#include <vector>
+#include <string_view>
+#include <memory>
+#include <tuple>
+#include <bitset>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <shared_mutex>
+#include <cstdio>
+#include <fstream>
+#include <cmath>
+#include <list>
 
 #include "HashMap.h"
+#include "FlatHashMap.h"
+#include "SwissHashMap.h"
+#include "ConcurrentHashMap.h"
+#include "LockFreeReadHashMap.h"
+#include "Hashers.h"
+#include "FrozenHashMap.h"
+#include "PerfectHashMap.h"
+#include "LruCache.h"
 
 using namespace pSTL;
 
+// Transparent string hashing/equality: std::string maps probed with string_view or const char*
+struct StringHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+};
+struct StringEqual {
+    using is_transparent = void;
+    bool operator()(std::string_view a, std::string_view b) const { return a == b; }
+};
+
+// std::hash / std::equal_to for strings that count their calls
+struct CountingStringHash {
+    static int calls;
+    size_t operator()(const std::string& s) const { ++calls; return std::hash<std::string>{}(s); }
+};
+int CountingStringHash::calls = 0;
+struct CountingStringEqual {
+    static int calls;
+    bool operator()(const std::string& a, const std::string& b) const { ++calls; return a == b; }
+};
+int CountingStringEqual::calls = 0;
+
+// Counts constructions to check that values are built exactly once, in place
+struct Counted {
+    static int constructions;
+    int a, b;
+
+    Counted() : a(0), b(0) { ++constructions; }
+    Counted(int x, int y) : a(x), b(y) { ++constructions; }
+    Counted(const Counted& o) : a(o.a), b(o.b) { ++constructions; }
+    Counted(Counted&& o) noexcept : a(o.a), b(o.b) { ++constructions; }
+    Counted& operator=(const Counted&) = default;
+    Counted& operator=(Counted&&) = default;
+};
+int Counted::constructions = 0;
+
+// Copy throws once copiesLeft runs out; the move is not noexcept, so
+// containers that want the strong guarantee copy it instead
+struct Fragile {
+    static int copiesLeft;
+    int v;
+
+    Fragile(int x = 0) : v(x) {}
+    Fragile(const Fragile& o) : v(o.v) {
+        if (copiesLeft-- == 0) throw std::runtime_error("Fragile: copy failed");
+    }
+    Fragile(Fragile&& o) : v(o.v) { o.v = -1; }
+    Fragile& operator=(const Fragile&) = default;
+    Fragile& operator=(Fragile&&) = default;
+};
+int Fragile::copiesLeft = 1 << 30;
+
+// Uniform insert/lookup/erase calls over the pSTL maps and std::unordered_map
+template <typename Map>
+void mapInsert(Map& map, uint64_t key, uint64_t value) { map.insert(key, value); }
+template <typename Map>
+bool mapContains(Map& map, uint64_t key) { return map.find(key) != nullptr; }
+
+void mapInsert(std::unordered_map<uint64_t, uint64_t>& map, uint64_t key, uint64_t value) { map[key] = value; }
+bool mapContains(std::unordered_map<uint64_t, uint64_t>& map, uint64_t key) { return map.find(key) != map.end(); }
+
+// Random insert/erase mix checked entry by entry against std::unordered_map
+template <typename Map>
+void checkAgainstReference(unsigned seed) {
+    Map map(4);
+    std::unordered_map<int, int> reference;
+    std::mt19937 rng(seed);
+    for (int step = 0; step < 200000; step++) {
+        int key = static_cast<int>(rng() % 5000);
+        if (rng() % 3 == 0) {
+            assert(map.erase(key) == (reference.erase(key) == 1));
+        }
+        else {
+            map.insert(key, step);
+            reference[key] = step;
+        }
+    }
+    assert(map.size() == reference.size());
+    for (int key = 0; key < 5000; key++) {
+        auto it = reference.find(key);
+        auto slot = map.find(key);
+        assert((slot != nullptr) == (it != reference.end()));
+        if (slot)
+            assert(slot->getValue() == it->second);
+    }
+}
+
+// Stateful hasher: a per-map seed, as used against hash flooding
+struct SeededHash {
+    using is_avalanching = void;
+    uint64_t seed = 0;
+    size_t operator()(const std::string& s) const { return static_cast<size_t>(hash_bytes(s.data(), s.size(), seed)); }
+};
+
+// HashMap that always rehashes incrementally, one bucket per operation
+struct IncrementalHashMap : HashMap<int, int> {
+    explicit IncrementalHashMap(size_t capacity) : HashMap<int, int>(capacity) { rehash_step(1); }
+};
+
+// Insert, hit lookup, miss lookup and erase of count random 64-bit keys, in ns per operation
+template <typename Map>
+void benchMap(const char* label, size_t count) {
+    std::mt19937_64 rng(count);
+    std::vector<uint64_t> keys(count);
+    for (auto& k : keys) k = rng() | 1;          // odd keys hit
+    std::vector<uint64_t> misses(count);
+    for (auto& k : misses) k = rng() & ~1ull;    // even keys miss
+    std::vector<uint64_t> probe = keys;
+    std::shuffle(probe.begin(), probe.end(), rng);
+
+    Map map;
+    map.reserve(count);
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < count; i++) mapInsert(map, keys[i], i);
+    auto t1 = std::chrono::high_resolution_clock::now();
+    size_t hits = 0;
+    for (uint64_t k : probe) hits += mapContains(map, k);
+    auto t2 = std::chrono::high_resolution_clock::now();
+    for (uint64_t k : misses) hits += mapContains(map, k);
+    auto t3 = std::chrono::high_resolution_clock::now();
+    for (uint64_t k : probe) map.erase(k);
+    auto t4 = std::chrono::high_resolution_clock::now();
+
+    auto perOp = [count](auto from, auto to) {
+        return std::chrono::duration<double, std::nano>(to - from).count() / count;
+    };
+    std::cout << label << " n=" << count << ": insert " << perOp(t0, t1) << " ns, hit " << perOp(t1, t2)
+        << " ns, miss " << perOp(t2, t3) << " ns, erase " << perOp(t3, t4) << " ns [" << hits % 10 << "]\n";
+}
+
+// Session-cache churn: a sliding window of live entries, each step inserts one and expires the oldest
+template <typename Map>
+void benchChurn(const char* label) {
+    const uint64_t window = 100000;
+    const uint64_t steps = 5000000;
+
+    Map map;
+    map.reserve(window * 2);
+    for (uint64_t k = 0; k < window; k++) mapInsert(map, k, k);
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    for (uint64_t k = window; k < window + steps; k++) {
+        mapInsert(map, k, k);
+        map.erase(k - window);
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double, std::nano> total = endTime - startTime;
+    std::cout << label << " churn, window " << window << ": " << total.count() / steps << " ns per insert+erase\n";
+}
+
+// std::string that opts out of hash caching, to measure what the cache buys
+struct UncachedString : std::string {
+    UncachedString(std::string s) : std::string(std::move(s)) {}
+};
+template <> struct pSTL::cache_hash_code<UncachedString> : std::false_type {};
+
+// Rehash and lookups of 200-byte string keys with and without cached hash codes
+template <typename Key>
+void benchLongKeys(const char* label) {
+    const int count = 200000;
+    std::vector<Key> keys;
+    for (int i = 0; i < count; i++) keys.emplace_back(std::string(192, 'k') + std::to_string(1000000 + i));
+
+    HashMap<Key, int, std::hash<std::string>> map(count);
+    map.max_load_factor(4.0f);
+    for (int i = 0; i < count; i++) map.insert(keys[i], i);
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    map.reserve(count * 4);
+    auto t1 = std::chrono::high_resolution_clock::now();
+    long long sum = 0;
+    for (int r = 0; r < 5; r++)
+        for (int i = 0; i < count; i++) sum += map.at(keys[i]);
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double, std::milli> rehash = t1 - t0;
+    std::chrono::duration<double, std::nano> lookups = t2 - t1;
+    std::cout << label << ": rehash of " << count << " 200-byte keys " << rehash.count() << " ms, lookup "
+        << lookups.count() / (5.0 * count) << " ns [" << sum % 10 << "]\n";
+}
+
+// Per-insert latency percentiles while a map grows from empty, with synchronous
+// or incremental rehashing (step = buckets moved per operation, 0 = synchronous)
+void benchInsertLatency(const char* label, size_t step) {
+    const size_t count = 4000000;
+    std::vector<double> samples(count);
+
+    HashMap<uint64_t, uint64_t> map;
+    map.rehash_step(step);
+    for (size_t i = 0; i < count; i++) {
+        auto t0 = std::chrono::steady_clock::now();
+        map.insert(i * 0x9E3779B97F4A7C15ull, i);
+        auto t1 = std::chrono::steady_clock::now();
+        samples[i] = std::chrono::duration<double, std::nano>(t1 - t0).count();
+    }
+
+    std::sort(samples.begin(), samples.end());
+    auto pct = [&](double p) { return samples[static_cast<size_t>(p * (count - 1))]; };
+    std::cout << label << " insert latency over " << count << ": p50 " << pct(0.5) << " ns, p99 " << pct(0.99)
+        << " ns, p999 " << pct(0.999) << " ns, p9999 " << pct(0.9999) << " ns, max " << samples.back() / 1e6 << " ms\n";
+}
+
+// Shared map under a read/write mix: sharded ConcurrentHashMap vs HashMap behind one mutex,
+// in million operations per second over all threads
+void benchConcurrentMix(unsigned readPercent) {
+    const uint64_t keys = 1 << 20;
+    const uint64_t totalOps = 4000000;
+    const unsigned threadCounts[] = { 1, 2, 4, 8, 16, 32, 64 };
+
+    auto run = [&](unsigned threads, auto&& op) {
+        std::vector<std::thread> workers;
+        auto startTime = std::chrono::high_resolution_clock::now();
+        for (unsigned t = 0; t < threads; t++) {
+            workers.emplace_back([&, t] {
+                std::mt19937_64 rng(t + 1);
+                for (uint64_t i = 0; i < totalOps / threads; i++) {
+                    uint64_t r = rng();
+                    op(r % keys, (r >> 32) % 100 < readPercent);
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+        auto endTime = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double, std::micro> total = endTime - startTime;
+        return totalOps / total.count();
+    };
+
+    for (unsigned threads : threadCounts) {
+        ConcurrentHashMap<uint64_t, uint64_t> sharded(0, keys);
+        HashMap<uint64_t, uint64_t> locked(keys);
+        std::mutex mutex;
+        for (uint64_t k = 0; k < keys; k += 2) {
+            sharded.insert(k, k);
+            locked.insert(k, k);
+        }
+
+        std::atomic<uint64_t> hits(0);
+        double shardedRate = run(threads, [&](uint64_t key, bool read) {
+            if (read) hits += sharded.find(key).has_value();
+            else if (key & 1) sharded.insert(key, key);
+            else sharded.erase(key);
+        });
+        double lockedRate = run(threads, [&](uint64_t key, bool read) {
+            std::lock_guard<std::mutex> guard(mutex);
+            if (read) hits += locked.find(key) != nullptr;
+            else if (key & 1) locked.insert(key, key);
+            else locked.erase(key);
+        });
+
+        std::cout << readPercent << "/" << 100 - readPercent << " read/write, " << threads << " threads: ConcurrentHashMap "
+            << shardedRate << " Mops/s, HashMap + mutex " << lockedRate << " Mops/s [" << hits % 10 << "]\n";
+    }
+}
+
+// Read-only lookups from many threads: LockFreeReadHashMap vs ConcurrentHashMap vs
+// HashMap behind a std::shared_mutex, in million lookups per second over all threads
+void benchLockFreeReads() {
+    const uint64_t keys = 1 << 18;
+    const uint64_t totalOps = 8000000;
+    const unsigned threadCounts[] = { 1, 2, 4, 8, 16 };
+
+    LockFreeReadHashMap<uint64_t, uint64_t> lockFree(keys);
+    ConcurrentHashMap<uint64_t, uint64_t> sharded(0, keys);
+    HashMap<uint64_t, uint64_t> locked(keys);
+    std::shared_mutex mutex;
+    for (uint64_t k = 0; k < keys; k++) {
+        lockFree.insert(k, k);
+        sharded.insert(k, k);
+        locked.insert(k, k);
+    }
+
+    std::atomic<uint64_t> sum(0);
+    auto run = [&](unsigned threads, auto&& lookup) {
+        std::vector<std::thread> workers;
+        auto startTime = std::chrono::high_resolution_clock::now();
+        for (unsigned t = 0; t < threads; t++) {
+            workers.emplace_back([&, t] {
+                std::mt19937_64 rng(t + 1);
+                uint64_t local = 0;
+                for (uint64_t i = 0; i < totalOps / threads; i++) local += lookup(rng() % keys);
+                sum += local;
+            });
+        }
+        for (auto& w : workers) w.join();
+        auto endTime = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double, std::micro> total = endTime - startTime;
+        return totalOps / total.count();
+    };
+
+    for (unsigned threads : threadCounts) {
+        double lockFreeRate = run(threads, [&](uint64_t key) { return *lockFree.find(key); });
+        double shardedRate = run(threads, [&](uint64_t key) { return *sharded.find(key); });
+        double lockedRate = run(threads, [&](uint64_t key) {
+            std::shared_lock<std::shared_mutex> lock(mutex);
+            return locked.find(key)->getValue();
+        });
+        std::cout << threads << " reader threads: LockFreeReadHashMap " << lockFreeRate << " Mops/s, ConcurrentHashMap "
+            << shardedRate << " Mops/s, HashMap + shared_mutex " << lockedRate << " Mops/s [" << sum % 10 << "]\n";
+    }
+}
+
+// Full scans of a map: range-for over iterators, and for_each_bucket_parallel, dense and after
+// erasing 15 of every 16 entries (bitmap skipping empty buckets)
+void benchTraversal(size_t count) {
+    HashMap<uint64_t, uint64_t> map(count);
+    for (uint64_t k = 0; k < count; k++) map.insert(k * 0x9E3779B97F4A7C15ull, k);
+
+    for (int pass = 0; pass < 2; pass++) {
+        auto t0 = std::chrono::high_resolution_clock::now();
+        uint64_t sum = 0;
+        for (const auto& [key, value] : map) sum += value;
+        auto t1 = std::chrono::high_resolution_clock::now();
+        std::atomic<uint64_t> parallelSum(0);
+        map.for_each_bucket_parallel([&](const uint64_t&, uint64_t& value) { parallelSum.fetch_add(value, std::memory_order_relaxed); });
+        auto t2 = std::chrono::high_resolution_clock::now();
+
+        std::chrono::duration<double, std::milli> serial = t1 - t0;
+        std::chrono::duration<double, std::milli> parallel = t2 - t1;
+        std::cout << "Traversal of " << map.size() << " entries in " << map.bucket_count() << " buckets: range-for "
+            << serial.count() << " ms, for_each_bucket_parallel (" << std::thread::hardware_concurrency() << " threads) "
+            << parallel.count() << " ms [" << (sum == parallelSum.load()) << "]\n";
+
+        for (uint64_t k = 0; k < count; k++)
+            if (k % 16) map.erase(k * 0x9E3779B97F4A7C15ull);
+    }
+}
+
+// Keeps benchmark results observable so the loops are not optimized out
+volatile size_t benchSink;
+
+// Expected nodes visited per successful lookup with the low bits of h as bucket index
+template <typename Hasher>
+double chainCost(const std::vector<uint64_t>& keys, size_t buckets) {
+    std::vector<uint32_t> counts(buckets);
+    for (uint64_t key : keys) counts[Hasher{}(key) & (buckets - 1)]++;
+    double cost = 0;
+    for (double c : counts) cost += c * (c + 1) / 2;
+    return cost / keys.size();
+}
+
+template <typename Hasher>
+double nsPerStringHash(const std::vector<std::string>& strings) {
+    size_t sink = 0;
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < 20; r++)
+        for (const auto& s : strings) sink += Hasher{}(s);
+    auto t1 = std::chrono::high_resolution_clock::now();
+    benchSink = sink;
+    std::chrono::duration<double, std::nano> total = t1 - t0;
+    return total.count() / (20.0 * strings.size());
+}
+
+template <typename Map, typename Key>
+double nsPerInsertFind(const std::vector<Key>& keys) {
+    Map map;
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < keys.size(); i++) map.insert(keys[i], i);
+    size_t sum = 0;
+    for (const auto& key : keys) sum += map.at(key);
+    auto t1 = std::chrono::high_resolution_clock::now();
+    benchSink = sum;
+    std::chrono::duration<double, std::nano> total = t1 - t0;
+    return total.count() / keys.size();
+}
+
+// Raw hash quality on structured keys, string hashing speed, and end-to-end map speed per hasher
+void benchHashers() {
+    const size_t count = 1 << 20;
+    std::vector<uint64_t> sequential(count), strided(count), highBits(count);
+    for (uint64_t i = 0; i < count; i++) {
+        sequential[i] = i;
+        strided[i] = i * 4096;
+        highBits[i] = i << 40;
+    }
+    const char* names[] = { "sequential", "stride 4096", "high bits " };
+    const std::vector<uint64_t>* sets[] = { &sequential, &strided, &highBits };
+    for (int s = 0; s < 3; s++) {
+        std::cout << "Chain cost, " << names[s] << " ids into " << count << " buckets: std::hash (unmixed) "
+            << chainCost<std::hash<uint64_t>>(*sets[s], count) << ", IntHash " << chainCost<IntHash>(*sets[s], count)
+            << " (uniform ~1.5)\n";
+    }
+
+    for (size_t len : { 8, 32, 256, 4096 }) {
+        std::vector<std::string> strings;
+        std::mt19937_64 rng(len);
+        for (size_t i = 0; i < (1 << 22) / len + 64; i++) {
+            std::string s(len, ' ');
+            for (auto& c : s) c = static_cast<char>('a' + rng() % 26);
+            strings.push_back(std::move(s));
+        }
+        double stdNs = nsPerStringHash<std::hash<std::string>>(strings);
+        double bytesNs = nsPerStringHash<BytesHash>(strings);
+        std::cout << len << "-byte strings: std::hash " << stdNs << " ns (" << len / stdNs << " GB/s), BytesHash "
+            << bytesNs << " ns (" << len / bytesNs << " GB/s)\n";
+    }
+
+    std::vector<uint64_t> ids(1000000);
+    for (uint64_t i = 0; i < ids.size(); i++) ids[i] = i << 12;
+    std::vector<std::string> words;
+    for (int i = 0; i < 1000000; i++) words.push_back("user:" + std::to_string(i * 7919LL) + ":session");
+    std::cout << "HashMap<uint64_t> 1M strided ids insert+find: std::hash " << nsPerInsertFind<HashMap<uint64_t, size_t>>(ids)
+        << " ns, IntHash " << nsPerInsertFind<HashMap<uint64_t, size_t, IntHash>>(ids) << " ns\n";
+    std::cout << "HashMap<std::string> 1M keys insert+find: std::hash " << nsPerInsertFind<HashMap<std::string, size_t>>(words)
+        << " ns, BytesHash " << nsPerInsertFind<HashMap<std::string, size_t, BytesHash>>(words) << " ns\n";
+}
+
+// Stand-in for what a join does with each match before probing the next key
+inline uint64_t joinWork(uint64_t value, int steps) {
+    for (int i = 0; i < steps; i++) value = value * 0x9E3779B97F4A7C15ull + i;
+    return value;
+}
+
+// Random hit lookups, per-key find vs find_batch, with no work and with some work per match (which
+// fills the out-of-order window and stops plain find from overlapping misses), plus insert vs insert_batch
+void benchBatchLookup(size_t count) {
+    std::vector<uint64_t> keys(count), values(count);
+    std::mt19937_64 rng(count);
+    for (size_t i = 0; i < count; i++) { keys[i] = rng(); values[i] = i; }
+
+    HashMap<uint64_t, uint64_t> map(count);
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < count; i++) map.insert(keys[i], values[i]);
+    auto t1 = std::chrono::high_resolution_clock::now();
+    HashMap<uint64_t, uint64_t> batched(count);
+    batched.insert_batch(keys.data(), values.data(), count);
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    auto ns = [](auto a, auto b, size_t ops) { return std::chrono::duration<double, std::nano>(b - a).count() / ops; };
+    std::cout << "HashMap " << count << " entries: insert " << ns(t0, t1, count) << " ns, insert_batch " << ns(t1, t2, count) << " ns\n";
+
+    const size_t lookups = 2000000;
+    std::vector<uint64_t> probes(lookups);
+    for (auto& p : probes) p = keys[rng() % count];
+    std::vector<HashMap<uint64_t, uint64_t>::node_t*> out(256);
+
+    for (int steps : { 0, 20 }) {
+        uint64_t sum = 0;
+        auto t3 = std::chrono::high_resolution_clock::now();
+        for (uint64_t key : probes) sum += joinWork(map.find(key)->getValue(), steps);
+        auto t4 = std::chrono::high_resolution_clock::now();
+        for (size_t base = 0; base < lookups; base += out.size()) {
+            size_t n = std::min(out.size(), lookups - base);
+            map.find_batch(probes.data() + base, n, out.data());
+            for (size_t i = 0; i < n; i++) sum += joinWork(out[i]->getValue(), steps);
+        }
+        auto t5 = std::chrono::high_resolution_clock::now();
+        std::cout << "  lookups with " << steps << " work steps per match: find " << ns(t3, t4, lookups) << " ns, find_batch "
+            << ns(t4, t5, lookups) << " ns [" << sum % 10 << "]\n";
+    }
+}
+
+// Cold start from a saved image: building the map vs saving it once and
+// mapping it with FrozenHashMap, then random hit lookups on both
+void benchFrozen(size_t count) {
+    const std::string path = "pstl_frozen_bench.bin";
+    std::vector<uint64_t> keys(count);
+    std::mt19937_64 rng(count);
+    for (auto& k : keys) k = rng();
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    HashMap<uint64_t, uint64_t> map;
+    for (size_t i = 0; i < count; i++) map.insert(keys[i], i);
+    auto t1 = std::chrono::high_resolution_clock::now();
+    map.save(path);
+    auto t2 = std::chrono::high_resolution_clock::now();
+    FrozenHashMap<uint64_t, uint64_t> frozen(path);
+    auto t3 = std::chrono::high_resolution_clock::now();
+
+    const size_t lookups = 2000000;
+    std::vector<uint64_t> probes(lookups);
+    for (auto& p : probes) p = keys[rng() % count];
+    uint64_t sum = 0;
+    auto t4 = std::chrono::high_resolution_clock::now();
+    for (uint64_t key : probes) sum += frozen.find(key)->getValue();
+    auto t5 = std::chrono::high_resolution_clock::now();
+    for (uint64_t key : probes) sum += map.find(key)->getValue();
+    auto t6 = std::chrono::high_resolution_clock::now();
+    benchSink = sum;
+
+    auto ms = [](auto a, auto b) { return std::chrono::duration<double, std::milli>(b - a).count(); };
+    auto ns = [](auto a, auto b, size_t ops) { return std::chrono::duration<double, std::nano>(b - a).count() / ops; };
+    std::cout << "FrozenHashMap " << count << " entries: build " << ms(t0, t1) << " ms, save " << ms(t1, t2) << " ms, open "
+        << ms(t2, t3) << " ms; find " << ns(t4, t5, lookups) << " ns (HashMap " << ns(t5, t6, lookups) << " ns)\n";
+    std::remove(path.c_str());
+}
+
+// Fixed dictionaries: a few dozen header names, and a large integer key set
+void benchPerfect(size_t count) {
+    static const char* names[] = { "Accept", "Accept-Charset", "Accept-Encoding", "Accept-Language", "Authorization", "Cache-Control",
+        "Connection", "Content-Encoding", "Content-Length", "Content-Type", "Cookie", "Date", "ETag", "Expect", "Expires", "From", "Host",
+        "If-Match", "If-Modified-Since", "If-None-Match", "If-Range", "If-Unmodified-Since", "Last-Modified", "Location", "Max-Forwards",
+        "Origin", "Pragma", "Range", "Referer", "Retry-After", "Server", "Set-Cookie", "TE", "Trailer", "Transfer-Encoding", "Upgrade",
+        "User-Agent", "Vary", "Via", "Warning", "WWW-Authenticate", "X-Forwarded-For", "X-Request-Id" };
+    constexpr size_t nameCount = sizeof(names) / sizeof(names[0]);
+    static constexpr std::pair<std::string_view, int> staticNames[] = { {"Accept", 0}, {"Accept-Charset", 1}, {"Accept-Encoding", 2},
+        {"Accept-Language", 3}, {"Authorization", 4}, {"Cache-Control", 5}, {"Connection", 6}, {"Content-Encoding", 7}, {"Content-Length", 8},
+        {"Content-Type", 9}, {"Cookie", 10}, {"Date", 11}, {"ETag", 12}, {"Expect", 13}, {"Expires", 14}, {"From", 15}, {"Host", 16},
+        {"If-Match", 17}, {"If-Modified-Since", 18}, {"If-None-Match", 19}, {"If-Range", 20}, {"If-Unmodified-Since", 21},
+        {"Last-Modified", 22}, {"Location", 23}, {"Max-Forwards", 24}, {"Origin", 25}, {"Pragma", 26}, {"Range", 27}, {"Referer", 28},
+        {"Retry-After", 29}, {"Server", 30}, {"Set-Cookie", 31}, {"TE", 32}, {"Trailer", 33}, {"Transfer-Encoding", 34}, {"Upgrade", 35},
+        {"User-Agent", 36}, {"Vary", 37}, {"Via", 38}, {"Warning", 39}, {"WWW-Authenticate", 40}, {"X-Forwarded-For", 41}, {"X-Request-Id", 42} };
+    static constexpr auto staticMap = StaticPerfectHashMap<std::string_view, int, nameCount>(staticNames);
+
+    HashMap<std::string, int> chained;
+    for (size_t i = 0; i < nameCount; i++) chained.insert(names[i], static_cast<int>(i));
+    PerfectHashMap<std::string, int> perfect(chained);
+    std::vector<std::string> probes(1000000);
+    std::mt19937_64 rng(count);
+    for (auto& p : probes) p = names[rng() % nameCount];
+
+    auto ns = [](auto a, auto b, size_t ops) { return std::chrono::duration<double, std::nano>(b - a).count() / ops; };
+    size_t sum = 0;
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (const auto& p : probes) sum += chained.find(p)->getValue();
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (const auto& p : probes) sum += perfect.find(p)->getValue();
+    auto t2 = std::chrono::high_resolution_clock::now();
+    for (const auto& p : probes) sum += staticMap.find(p)->getValue();
+    auto t3 = std::chrono::high_resolution_clock::now();
+    std::cout << "Header names (" << nameCount << "): HashMap " << ns(t0, t1, probes.size()) << " ns, PerfectHashMap " << ns(t1, t2, probes.size())
+        << " ns, StaticPerfectHashMap " << ns(t2, t3, probes.size()) << " ns\n";
+
+    HashMap<uint64_t, uint64_t> numbers(count);
+    std::vector<uint64_t> keys(count);
+    for (size_t i = 0; i < count; i++) { keys[i] = rng(); numbers.insert(keys[i], i); }
+    auto t4 = std::chrono::high_resolution_clock::now();
+    PerfectHashMap<uint64_t, uint64_t> perfectNumbers(numbers);
+    auto t5 = std::chrono::high_resolution_clock::now();
+    std::vector<uint64_t> numberProbes(2000000);
+    for (auto& p : numberProbes) p = keys[rng() % count];
+    auto t6 = std::chrono::high_resolution_clock::now();
+    for (uint64_t p : numberProbes) sum += numbers.find(p)->getValue();
+    auto t7 = std::chrono::high_resolution_clock::now();
+    for (uint64_t p : numberProbes) sum += perfectNumbers.find(p)->getValue();
+    auto t8 = std::chrono::high_resolution_clock::now();
+    benchSink = sum;
+    std::cout << "Integers (" << count << "): build " << std::chrono::duration<double, std::milli>(t5 - t4).count() << " ms, HashMap "
+        << ns(t6, t7, numberProbes.size()) << " ns, PerfectHashMap " << ns(t7, t8, numberProbes.size()) << " ns\n";
+}
+
+// Read-through cache over Zipf(1) keys: get, put on a miss
+void benchCache(size_t capacity) {
+    const size_t universe = 1 << 22;
+    std::vector<uint64_t> keys(4000000);
+    std::mt19937_64 rng(capacity);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    for (auto& k : keys) k = static_cast<uint64_t>(std::pow(static_cast<double>(universe), unit(rng))) * 0x9E3779B97F4A7C15ull;
+
+    auto ns = [](auto a, auto b, size_t ops) { return std::chrono::duration<double, std::nano>(b - a).count() / ops; };
+    auto run = [&](const char* label, auto&& lookup) {
+        size_t hits = 0;
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for (uint64_t k : keys) hits += lookup(k);
+        auto t1 = std::chrono::high_resolution_clock::now();
+        std::cout << "  " << label << ns(t0, t1, keys.size()) << " ns/op, hit ratio " << static_cast<double>(hits) / keys.size() << "\n";
+    };
+
+    std::cout << "Cache of " << capacity << " over Zipf keys:\n";
+    {
+        // The usual hand-rolled LRU: a second allocation per entry for the list
+        std::list<std::pair<uint64_t, uint64_t>> order;
+        std::unordered_map<uint64_t, std::list<std::pair<uint64_t, uint64_t>>::iterator> index;
+        run("std::list + unordered_map ", [&](uint64_t k) {
+            auto it = index.find(k);
+            if (it != index.end()) {
+                order.splice(order.begin(), order, it->second);
+                benchSink = it->second->second;
+                return true;
+            }
+            order.emplace_front(k, k);
+            index[k] = order.begin();
+            if (order.size() > capacity) {
+                index.erase(order.back().first);
+                order.pop_back();
+            }
+            return false;
+        });
+    }
+    {
+        LruCache<uint64_t, uint64_t> lru(capacity);
+        run("LruCache                  ", [&](uint64_t k) {
+            if (uint64_t* v = lru.get(k)) { benchSink = *v; return true; }
+            lru.put(k, k);
+            return false;
+        });
+    }
+    {
+        ClockCache<uint64_t, uint64_t> clock(capacity);
+        run("ClockCache                ", [&](uint64_t k) {
+            if (uint64_t* v = clock.get(k)) { benchSink = *v; return true; }
+            clock.put(k, k);
+            return false;
+        });
+    }
+
+    // Same keys split over threads, get-then-put on each
+    auto runSharded = [&](const char* label, auto& cache, unsigned threads) {
+        std::vector<std::thread> workers;
+        std::atomic<size_t> hits(0);
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for (unsigned t = 0; t < threads; t++) {
+            workers.emplace_back([&, t] {
+                size_t local = 0;
+                for (size_t i = t; i < keys.size(); i += threads) {
+                    if (cache.get(keys[i])) local++;
+                    else cache.put(keys[i], keys[i]);
+                }
+                hits += local;
+            });
+        }
+        for (auto& w : workers) w.join();
+        auto t1 = std::chrono::high_resolution_clock::now();
+        std::cout << "  " << label << threads << " threads: " << keys.size() / std::chrono::duration<double, std::micro>(t1 - t0).count()
+            << " Mops/s, hit ratio " << static_cast<double>(hits) / keys.size() << "\n";
+    };
+    for (unsigned threads : { 1, 4, 16 }) {
+        ShardedCache<LruCache<uint64_t, uint64_t>> lru(capacity);
+        ShardedCache<ClockCache<uint64_t, uint64_t>> clock(capacity);
+        runSharded("ShardedCache<LruCache>,   ", lru, threads);
+        runSharded("ShardedCache<ClockCache>, ", clock, threads);
+    }
+}
+
+void benchMaps() {
+    for (size_t n : { 1 << 12, 1 << 16, 1 << 20 })
+        benchCache(n);
+    for (size_t n : { 1 << 16, 1 << 20, 1 << 23 })
+        benchPerfect(n);
+    for (size_t n : { 1 << 20, 10000000 })
+        benchFrozen(n);
+#ifdef PSTL_BENCHMARK_HUGE
+    benchFrozen(40000000);
+#endif
+    for (size_t n : { 1 << 14, 1 << 20, 1 << 23 })
+        benchBatchLookup(n);
+    benchHashers();
+    benchTraversal(10000000);
+#ifdef PSTL_BENCHMARK_HUGE
+    benchTraversal(100000000);
+#endif
+    benchLockFreeReads();
+    benchConcurrentMix(90);
+    benchConcurrentMix(50);
+    benchInsertLatency("synchronous rehash        ", 0);
+    benchInsertLatency("incremental rehash, step 4", 4);
+
+    benchLongKeys<std::string>("cached hash  ");
+    benchLongKeys<UncachedString>("uncached hash");
+    benchChurn<HashMap<uint64_t, uint64_t>>("HashMap           ");
+    benchChurn<std::unordered_map<uint64_t, uint64_t>>("std::unordered_map");
+
+    std::vector<size_t> sizes = { 1000, 100000, 1000000, 10000000 };
+#ifdef PSTL_BENCHMARK_HUGE
+    sizes.push_back(100000000);
+#endif
+    for (size_t n : sizes) {
+        benchMap<HashMap<uint64_t, uint64_t>>("HashMap           ", n);
+        benchMap<FlatHashMap<uint64_t, uint64_t>>("FlatHashMap       ", n);
+        benchMap<SwissHashMap<uint64_t, uint64_t>>("SwissHashMap      ", n);
+        benchMap<std::unordered_map<uint64_t, uint64_t>>("std::unordered_map", n);
+    }
+}
+
 int main() {
     // ===== Test operator[] and basic insertion =====
     {
@@ -149,6 +840,33 @@ int main() {
         assert(hm2[6] == "six");
     }
 
+    // ===== Test reuse of a moved-from map =====
+    {
+        HashMap<int, std::string> source;
+        source.insert(1, "one");
+        HashMap<int, std::string> target = std::move(source);
+
+        assert(source.size() == 0 && source.find(1) == nullptr && !source.erase(1));
+        bool movedThrew = false;
+        try { (void)source.at(1); }
+        catch (const std::out_of_range&) { movedThrew = true; }
+        assert(movedThrew && source.begin() == source.end());
+        int movedKeys[3] = { 1, 2, 3 };
+        HashMap<int, std::string>::node_t* movedOut[3] = {};
+        source.find_batch(movedKeys, 3, movedOut);
+        assert(!movedOut[0] && !movedOut[1] && !movedOut[2]);
+        HashMap<int, std::string> copyOfEmpty = source;
+        assert(copyOfEmpty.empty());
+
+        source[2] = "two";
+        source.insert(3, "three");
+        assert(source.size() == 2 && source.at(2) == "two" && source.erase(3) && source.size() == 1);
+
+        target = std::move(source);
+        source.insert(4, "four");
+        assert(target.size() == 1 && target.at(2) == "two" && source.at(4) == "four");
+    }
+
     // ===== Test reserve() and grow() =====
     {
         HashMap<int, std::string> hm;
@@ -168,5 +886,1041 @@ int main() {
         assert(hm.size() == originalSize);
     }
 
+    // ===== Test automatic rehashing and bucket queries =====
+    {
+        HashMap<int, int> hm;
+        assert(hm.bucket_count() == 16);
+        assert(hm.max_load_factor() == 1.0f);
+
+        for (int i = 0; i < 1000000; i++) hm.insert(i, i);
+        assert(hm.size() == 1000000);
+        assert(hm.load_factor() <= hm.max_load_factor());
+
+        size_t buckets = hm.bucket_count();
+        assert((buckets & (buckets - 1)) == 0 && buckets >= 1000000);
+
+        size_t total = 0, longest = 0;
+        for (size_t b = 0; b < buckets; b++) {
+            size_t n = hm.bucket_size(b);
+            total += n;
+            longest = std::max(longest, n);
+        }
+        assert(total == hm.size());
+        assert(longest < 16);
+
+        for (int i = 0; i < 1000000; i += 997) assert(hm.at(i) == i);
+
+        hm.max_load_factor(0.25f);
+        assert(hm.bucket_count() >= 4 * hm.size() && hm.load_factor() <= 0.25f);
+
+        bool exceptionThrown = false;
+        try {
+            hm.max_load_factor(0.0f);
+        }
+        catch (const std::invalid_argument&) {
+            exceptionThrown = true;
+        }
+        assert(exceptionThrown);
+
+        exceptionThrown = false;
+        try {
+            hm.bucket_size(hm.bucket_count());
+        }
+        catch (const std::out_of_range&) {
+            exceptionThrown = true;
+        }
+        assert(exceptionThrown);
+
+        HashMap<int, int> sized(100);
+        assert(sized.bucket_count() == 128);
+        sized.reserve(129);
+        assert(sized.bucket_count() == 256);
+
+        // operator[] grows as well
+        HashMap<int, int> viaIndex(1);
+        for (int i = 0; i < 1000; i++) viaIndex[i] = i;
+        assert(viaIndex.load_factor() <= 1.0f && viaIndex[999] == 999);
+    }
+
+    // ===== Test node pool reuse and sharing =====
+    {
+        HashMap<int, std::string> hm;
+        for (int i = 0; i < 1000; i++) hm.insert(i, std::to_string(i));
+        auto pool = hm.pool();
+        assert(pool->live() == 1000);
+        size_t blocks = pool->block_count();
+
+        for (int round = 0; round < 10; round++) {
+            for (int i = 0; i < 1000; i++) assert(hm.erase(i));
+            for (int i = 0; i < 1000; i++) hm.insert(i, std::to_string(-i));
+        }
+        assert(pool->live() == 1000 && pool->block_count() == blocks);
+        assert(hm.at(7) == "-7");
+
+        // Shared pool: nodes go back to the free list, blocks stay
+        HashMap<int, std::string> other(16, pool);
+        other.insert(1, "one");
+        assert(pool->live() == 1001);
+        hm.clear();
+        assert(hm.empty() && pool->live() == 1 && pool->block_count() == blocks);
+        assert(other.at(1) == "one");
+
+        // Sole owner: clear frees every block at once
+        pool.reset();
+        HashMap<int, int> solo;
+        for (int i = 0; i < 5000; i++) solo[i] = i;
+        assert(solo.pool()->block_count() > 0);
+        solo.clear();
+        assert(solo.pool()->block_count() == 0 && solo.pool()->live() == 0);
+        solo[3] = 3;
+        assert(solo.at(3) == 3);
+
+        HashMap<int, int> copy = solo;
+        assert(copy.pool() != solo.pool() && copy.at(3) == 3);
+        HashMap<int, int> moved = std::move(copy);
+        moved[4] = 4;
+        assert(moved.size() == 2 && moved.pool()->live() == 2);
+    }
+
+    // ===== Test heterogeneous lookup =====
+    {
+        HashMap<std::string, int, StringHash, StringEqual> hm;
+        hm.insert("alpha", 1);
+        hm["beta"] = 2;
+
+        std::string_view view = "alpha";
+        assert(hm.find(view) != nullptr && hm.find(view)->getValue() == 1);
+        assert(hm.at(std::string_view("beta")) == 2);
+        assert(hm.find("gamma") == nullptr);
+
+        auto emplaced = hm.emplace(std::string_view("gamma"), 3);
+        assert(emplaced.second && emplaced.first->getKey() == "gamma");
+        assert(!hm.emplace("gamma", 30).second && hm.at("gamma") == 3);
+
+        assert(hm.erase(std::string_view("alpha")));
+        assert(!hm.erase("alpha"));
+        assert(hm.size() == 2);
+    }
+
+    // ===== Test try_emplace, insert_or_assign and emplace =====
+    {
+        HashMap<int, Counted> hm;
+        Counted::constructions = 0;
+
+        auto r = hm.try_emplace(1, 10, 20);
+        assert(r.second && r.first->getValue().a == 10 && r.first->getValue().b == 20);
+        assert(Counted::constructions == 1);
+
+        r = hm.try_emplace(1, 99, 99);
+        assert(!r.second && r.first->getValue().a == 10);
+        assert(Counted::constructions == 1 && hm.pool()->live() == 1);
+
+        r = hm.insert_or_assign(1, Counted(7, 8));
+        assert(!r.second && hm.at(1).a == 7);
+        r = hm.insert_or_assign(2, Counted(5, 6));
+        assert(r.second && hm.at(2).b == 6);
+
+        r = hm.emplace(3, 1, 2);
+        assert(r.second && hm.at(3).a == 1);
+        assert(!hm.emplace(3, 4, 5).second && hm.at(3).a == 1);
+
+        // Arguments are not consumed when the key is already present
+        HashMap<std::string, std::unique_ptr<int>> owners;
+        auto p = std::make_unique<int>(5);
+        assert(owners.try_emplace("k", std::move(p)).second && !p);
+        auto q = std::make_unique<int>(6);
+        assert(!owners.try_emplace("k", std::move(q)).second && q && *q == 6);
+        assert(*owners.at("k") == 5);
+
+        // Non-transparent map: emplace builds the key once on the stack for the probe
+        auto e = owners.emplace("other", std::make_unique<int>(1));
+        assert(e.second && *e.first->getValue() == 1);
+
+        std::string movedKey = "moved";
+        owners.try_emplace(std::move(movedKey), nullptr);
+        assert(owners.find("moved") != nullptr);
+    }
+
+    // ===== Test cached hash codes =====
+    {
+        static_assert(cache_hash_code<std::string>::value, "strings cache their hash");
+        static_assert(!cache_hash_code<int>::value, "scalars do not");
+        static_assert(sizeof(HashMap<int, int>::node_t) == sizeof(Node<int, int, false>), "no hash slot for scalar keys");
+
+        HashMap<std::string, int, CountingStringHash, CountingStringEqual> hm;
+        hm.max_load_factor(8.0f); // long chains
+        for (int i = 0; i < 1000; i++) hm.insert(std::string(200, 'x') + std::to_string(i), i);
+
+        CountingStringHash::calls = 0;
+        hm.reserve(1 << 14);
+        hm.grow();
+        assert(CountingStringHash::calls == 0);
+
+        // Other chain entries are rejected by hash; one key comparison per hit
+        CountingStringEqual::calls = 0;
+        for (int i = 0; i < 1000; i++) assert(hm.at(std::string(200, 'x') + std::to_string(i)) == i);
+        assert(CountingStringEqual::calls == 1000);
+
+        HashMap<std::string, int, CountingStringHash, CountingStringEqual> copy = hm;
+        CountingStringHash::calls = 0;
+        copy.reserve(1 << 16);
+        assert(CountingStringHash::calls == 0 && copy.at(std::string(200, 'x') + "999") == 999);
+        assert(copy.erase(std::string(200, 'x') + "5") && copy.size() == 999);
+    }
+
+    // ===== Test incremental rehashing =====
+    {
+        HashMap<int, int> hm(16);
+        hm.rehash_step(1);
+        assert(hm.rehash_step() == 1 && !hm.rehashing());
+
+        for (int i = 0; i < 16; i++) hm.insert(i, i);
+        assert(!hm.rehashing() && hm.bucket_count() == 16);
+
+        hm.insert(16, 16); // crosses the load factor: new table, 16 old buckets left to move
+        assert(hm.rehashing() && hm.bucket_count() == 32);
+
+        // Every entry stays reachable while split across both tables
+        for (int i = 0; i <= 16; i++) assert(hm.find(i) && hm.at(i) == i);
+        assert(!hm.rehashing()); // the lookups above moved the rest
+
+        hm.insert(32, 32);
+        for (int i = 17; i < 32; i++) hm.insert(i, i);
+        hm.insert(33, 33);
+        assert(hm.rehashing() && hm.bucket_count() == 64);
+
+        // Erase and overwrite entries that may still sit in the old table
+        assert(hm.erase(3) && !hm.erase(3) && hm.size() == 33);
+        hm.insert(5, 50);
+        hm[6] = 60;
+        assert(hm.at(5) == 50 && hm.at(6) == 60 && hm.size() == 33);
+
+        // Const lookups read both tables and leave the migration where it
+        // was: 34 non-const ones would have moved the 32 old buckets
+        const HashMap<int, int>& view = hm;
+        for (int i = 0; i <= 33; i++) assert(view.contains(i) == (i != 3));
+        assert(view.find(6)->getValue() == 60 && !view.find(3) && hm.rehashing());
+
+        // Copies and moves are complete maps; the source keeps migrating
+        HashMap<int, int> copy = hm;
+        assert(!copy.rehashing() && copy.size() == 33 && copy.at(32) == 32 && !copy.find(3));
+        HashMap<int, int> moved = std::move(copy);
+        assert(moved.rehash_step() == 1 && moved.at(33) == 33);
+
+        size_t total = 0;
+        for (size_t b = 0; b < hm.bucket_count(); b++) total += hm.bucket_size(b);
+        assert(total <= hm.size()); // bucket_size only covers the new table
+
+        hm.rehash_step(0); // back to synchronous: finishes the pending move
+        assert(!hm.rehashing());
+        total = 0;
+        for (size_t b = 0; b < hm.bucket_count(); b++) total += hm.bucket_size(b);
+        assert(total == hm.size());
+
+        hm.rehash_step(2);
+        hm.insert(1000, 1);
+        hm.reserve(1024); // explicit reserve is synchronous
+        assert(!hm.rehashing() && hm.bucket_count() == 1024 && hm.at(1000) == 1);
+
+        hm.insert(2000, 2);
+        hm.clear();
+        assert(hm.empty() && !hm.find(2000));
+
+        checkAgainstReference<IncrementalHashMap>(7);
+    }
+
+    // ===== Test FlatHashMap basic API =====
+    {
+        FlatHashMap<int, std::string> fm;
+        assert(fm.empty());
+
+        fm[1] = "one";
+        fm.insert(2, "two");
+        fm.insert(2, "TWO");
+        assert(fm.size() == 2);
+        assert(fm.at(1) == "one" && fm[2] == "TWO");
+        assert(fm[3] == "" && fm.size() == 3);
+
+        auto slot = fm.find(2);
+        assert(slot != nullptr && slot->getKey() == 2 && slot->getValue() == "TWO");
+        assert(fm.find(42) == nullptr);
+
+        bool exceptionThrown = false;
+        try {
+            fm.at(42);
+        }
+        catch (const std::out_of_range&) {
+            exceptionThrown = true;
+        }
+        assert(exceptionThrown);
+
+        FlatHashMap<int, std::string> init = { {1, "a"}, {2, "b"}, {1, "c"} };
+        assert(init.size() == 2 && init[1] == "c");
+    }
+
+    // ===== Test FlatHashMap growth and backward-shift erase =====
+    {
+        checkAgainstReference<FlatHashMap<int, int>>(7);
+
+        // Keys sharing one home slot form a single long cluster
+        FlatHashMap<int, int> clustered;
+        for (int i = 0; i < 1000; i++) clustered[i * 1024] = i;
+        for (int i = 0; i < 1000; i += 2) assert(clustered.erase(i * 1024));
+        for (int i = 0; i < 1000; i++) assert((clustered.find(i * 1024) != nullptr) == (i % 2 == 1));
+        assert(clustered.size() == 500);
+    }
+
+    // ===== Test FlatHashMap copy, move, reserve and clear =====
+    {
+        FlatHashMap<std::string, int> fm;
+        for (int i = 0; i < 100; i++) fm.insert("key" + std::to_string(i), i);
+
+        FlatHashMap<std::string, int> copy = fm;
+        copy["key0"] = -1;
+        assert(copy.size() == 100 && copy["key0"] == -1 && fm["key0"] == 0);
+
+        FlatHashMap<std::string, int> moved = std::move(copy);
+        assert(moved.size() == 100 && moved.at("key99") == 99);
+        assert(copy.size() == 0 && copy.find("key1") == nullptr);
+        copy["again"] = 1;
+        assert(copy.size() == 1);
+
+        copy = moved;
+        assert(copy.size() == 100 && copy.at("key0") == -1);
+
+        moved.reserve(10000);
+        moved.grow();
+        for (int i = 1; i < 100; i++) assert(moved.at("key" + std::to_string(i)) == i);
+
+        moved.clear();
+        assert(moved.empty() && moved.find("key5") == nullptr);
+        moved.insert("x", 1);
+        assert(moved.size() == 1);
+
+        moved.swap(fm);
+        assert(moved.size() == 100 && fm.size() == 1);
+    }
+
+    // ===== Test FlatHashMap failed rehash leaves the map intact =====
+    {
+        FlatHashMap<int, Fragile> fm(8);
+        for (int i = 0; i < 14; i++) fm.insert(i, Fragile(i * 7));
+        Fragile::copiesLeft = 5;
+        bool threw = false;
+        try { fm.insert(14, Fragile(98)); } // 7/8 load: grows, and the 6th copy throws mid-rehash
+        catch (const std::runtime_error&) { threw = true; }
+        Fragile::copiesLeft = 1 << 30;
+        assert(threw && fm.size() == 14 && !fm.find(14));
+        for (int i = 0; i < 14; i++) assert(fm.at(i).v == i * 7);
+        fm.insert(14, Fragile(98));
+        for (int i = 0; i < 15; i++) assert(fm.at(i).v == i * 7);
+    }
+
+    // ===== Test SwissHashMap =====
+    {
+        SwissHashMap<int, std::string> sm;
+        assert(sm.empty());
+
+        sm[1] = "one";
+        sm.insert(2, "two");
+        sm.insert(2, "TWO");
+        assert(sm.size() == 2 && sm.at(1) == "one" && sm[2] == "TWO");
+        assert(sm[3] == "" && sm.size() == 3);
+
+        auto slot = sm.find(2);
+        assert(slot != nullptr && slot->getKey() == 2 && slot->getValue() == "TWO");
+        assert(sm.find(42) == nullptr);
+
+        bool exceptionThrown = false;
+        try {
+            sm.at(42);
+        }
+        catch (const std::out_of_range&) {
+            exceptionThrown = true;
+        }
+        assert(exceptionThrown);
+
+        checkAgainstReference<SwissHashMap<int, int>>(11);
+
+        // Churn at constant size: tombstones must be purged, not grow the table forever
+        SwissHashMap<int, int> churn(64);
+        for (int i = 0; i < 100000; i++) {
+            churn.insert(i, i);
+            if (i >= 50) assert(churn.erase(i - 50));
+        }
+        assert(churn.size() == 50);
+        for (int i = 100000 - 50; i < 100000; i++) assert(churn.at(i) == i);
+
+        SwissHashMap<std::string, int> named = { {"a", 1}, {"b", 2} };
+        SwissHashMap<std::string, int> copy = named;
+        copy["a"] = 10;
+        assert(named.at("a") == 1 && copy.at("a") == 10);
+        SwissHashMap<std::string, int> moved = std::move(copy);
+        assert(moved.size() == 2 && copy.size() == 0 && copy.find("a") == nullptr);
+        moved.reserve(1000);
+        moved.grow();
+        assert(moved.at("b") == 2);
+        moved.clear();
+        assert(moved.empty() && moved.find("b") == nullptr);
+
+        // A copy failing mid-rehash leaves every entry in place; so does one
+        // failing while copying the whole map
+        SwissHashMap<int, Fragile> fragile(8);
+        for (int i = 0; i < 14; i++) fragile.insert(i, Fragile(i * 7));
+        Fragile::copiesLeft = 5;
+        bool rehashThrew = false;
+        try { fragile.insert(14, Fragile(98)); }
+        catch (const std::runtime_error&) { rehashThrew = true; }
+        Fragile::copiesLeft = 5;
+        bool copyThrew = false;
+        try { SwissHashMap<int, Fragile> partial = fragile; }
+        catch (const std::runtime_error&) { copyThrew = true; }
+        Fragile::copiesLeft = 1 << 30;
+        assert(rehashThrew && copyThrew && fragile.size() == 14 && !fragile.find(14));
+        for (int i = 0; i < 14; i++) assert(fragile.at(i).v == i * 7);
+        fragile.insert(14, Fragile(98));
+        assert(fragile.size() == 15 && fragile.at(14).v == 98 && fragile.at(3).v == 21);
+    }
+
+    // ===== Test HashMap::for_each =====
+    {
+        HashMap<int, int> hm(4);
+        hm.rehash_step(1);
+        for (int i = 0; i < 100; i++) hm.insert(i, i * 2);
+        assert(hm.rehashing()); // entries split across both tables are all visited
+
+        long long keySum = 0, valueSum = 0;
+        size_t visited = 0;
+        hm.for_each([&](const int& key, int& value) { keySum += key; valueSum += value; value++; visited++; });
+        assert(visited == 100 && keySum == 4950 && valueSum == 9900);
+
+        const HashMap<int, int>& constRef = hm;
+        valueSum = 0;
+        constRef.for_each([&](const int&, const int& value) { valueSum += value; });
+        assert(valueSum == 9900 + 100);
+    }
+
+    // ===== Test HashMap iterators =====
+    {
+        HashMap<int, int> empty;
+        assert(empty.begin() == empty.end() && empty.cbegin() == empty.cend());
+
+        HashMap<std::string, int> hm;
+        for (int i = 0; i < 100; i++) hm.insert("k" + std::to_string(i), i);
+
+        int count = 0, sum = 0;
+        for (const auto& [key, value] : hm) {
+            assert(key == "k" + std::to_string(value));
+            count++;
+            sum += value;
+        }
+        assert(count == 100 && sum == 4950);
+
+        for (auto& [key, value] : hm) value *= 2; // writes through
+        assert(hm.at("k7") == 14);
+
+        HashMap<std::string, int>::iterator it = hm.begin();
+        HashMap<std::string, int>::const_iterator cit = it; // iterator -> const_iterator
+        assert(cit->second == it->second && (*it).first == cit->first);
+        auto prev = it++;
+        assert(prev != it && std::next(prev) == it);
+        static_assert(std::is_same<std::iterator_traits<decltype(it)>::iterator_category, std::forward_iterator_tag>::value, "forward iterator");
+
+        const HashMap<std::string, int>& constRef = hm;
+        assert(std::distance(constRef.begin(), constRef.end()) == 100);
+        auto found = std::find_if(hm.cbegin(), hm.cend(), [](const auto& entry) { return entry.second == 198; });
+        assert(found != hm.cend() && found->first == "k99");
+
+        // Sparse map: few entries spread over many buckets
+        HashMap<int, int> sparse(1 << 16);
+        for (int i = 0; i < 1000; i++) sparse.insert(i, i);
+        for (int i = 0; i < 1000; i++) if (i % 100) sparse.erase(i);
+        std::vector<int> keys;
+        for (const auto& entry : sparse) keys.push_back(entry.first);
+        std::sort(keys.begin(), keys.end());
+        assert(keys == std::vector<int>({ 0, 100, 200, 300, 400, 500, 600, 700, 800, 900 }));
+        sparse.clear();
+        assert(sparse.begin() == sparse.end());
+        sparse.insert(5, 5);
+        assert(sparse.begin()->first == 5 && std::next(sparse.begin()) == sparse.end());
+
+        // Mid-rehash: entries from both tables are visited exactly once
+        HashMap<int, int> split(16);
+        split.rehash_step(1);
+        for (int i = 0; i < 40; i++) split.insert(i, i);
+        assert(split.rehashing());
+        std::vector<int> seen;
+        for (const auto& entry : split) seen.push_back(entry.first);
+        std::sort(seen.begin(), seen.end());
+        assert(seen.size() == 40 && seen.front() == 0 && seen.back() == 39 && std::adjacent_find(seen.begin(), seen.end()) == seen.end());
+
+        // Parallel scan covers every entry once, uneven splits included
+        HashMap<int, int> big(1 << 15);
+        for (int i = 0; i < 50000; i++) big.insert(i, 1);
+        for (unsigned threads : { 0u, 1u, 3u, 8u }) {
+            std::atomic<long long> total(0);
+            big.for_each_bucket_parallel([&](const int& key, int& value) { total += key; value++; }, threads);
+            assert(total.load() == 50000LL * 49999 / 2);
+        }
+        assert(big.at(123) == 5);
+
+        bool threw = false;
+        try { big.for_each_bucket_parallel([](const int& key, int&) { if (key == 777) throw std::runtime_error("stop"); }, 4); }
+        catch (const std::runtime_error&) { threw = true; }
+        assert(threw);
+
+        HashMap<int, int> tiny;
+        int visited = 0;
+        tiny.for_each_bucket_parallel([&](const int&, int&) { visited++; }, 8); // runs on the calling thread
+        tiny.insert(1, 1);
+        tiny.for_each_bucket_parallel([&](const int&, int&) { visited++; }, 8);
+        assert(visited == 1);
+    }
+
+    // ===== Test hashers =====
+    {
+        static_assert(is_avalanching<IntHash>::value && is_avalanching<BytesHash>::value && is_avalanching<FastHash<std::pair<int, int>>>::value, "shipped hashers avalanche");
+        static_assert(!is_avalanching<std::hash<int>>::value, "std::hash is mixed by the map");
+
+        // Deterministic, length-sensitive, every input size path covered
+        std::string text(300, '\0');
+        for (size_t i = 0; i < text.size(); i++) text[i] = static_cast<char>('a' + i % 26);
+        std::vector<uint64_t> prefixHashes;
+        for (size_t len = 0; len <= text.size(); len++) {
+            assert(hash_bytes(text.data(), len) == hash_bytes(std::string(text, 0, len).data(), len));
+            prefixHashes.push_back(hash_bytes(text.data(), len));
+        }
+        std::sort(prefixHashes.begin(), prefixHashes.end());
+        assert(std::adjacent_find(prefixHashes.begin(), prefixHashes.end()) == prefixHashes.end());
+        assert(hash_bytes("abc", 3, 1) != hash_bytes("abc", 3, 2));
+        assert(BytesHash{}(std::string("route")) == BytesHash{}(std::string_view("route")) && BytesHash{}("route") == BytesHash{}(std::string("route")));
+
+        // Flipping one input bit flips about half of the output bits
+        double flipped = 0;
+        int trials = 0;
+        for (uint64_t x = 1; x < 2000; x += 7) {
+            for (int b = 0; b < 64; b++, trials++) {
+                flipped += std::bitset<64>(hash_int(x) ^ hash_int(x ^ (1ull << b))).count();
+            }
+        }
+        assert(flipped / trials > 28 && flipped / trials < 36);
+
+        // Strided ids: the low bits of the identity std::hash are all zero, IntHash spreads them
+        std::vector<int> identityBuckets(1024), mixedBuckets(1024);
+        for (uint64_t id = 0; id < 65536; id++) {
+            identityBuckets[std::hash<uint64_t>{}(id * 4096) & 1023]++;
+            mixedBuckets[IntHash{}(id * 4096) & 1023]++;
+        }
+        assert(*std::max_element(identityBuckets.begin(), identityBuckets.end()) == 65536);
+        assert(*std::max_element(mixedBuckets.begin(), mixedBuckets.end()) < 128);
+
+        // Combiner: order matters, pairs and tuples agree with hash_combine's inputs
+        assert(hash_combine(1, 2) != hash_combine(2, 1));
+        using PairHash = FastHash<std::pair<int, int>>;
+        using TupleHash = FastHash<std::tuple<int, std::string>>;
+        assert(PairHash{}(std::make_pair(1, 2)) != PairHash{}(std::make_pair(2, 1)));
+        assert(TupleHash{}(std::make_tuple(1, std::string("a"))) == CombineHash{}(std::make_tuple(1, std::string("a"))));
+
+        HashMap<std::pair<int, int>, int, PairHash> grid;
+        for (int x = 0; x < 50; x++)
+            for (int y = 0; y < 50; y++) grid.insert({ x, y }, x * 100 + y);
+        assert(grid.size() == 2500 && grid.at(std::make_pair(12, 34)) == 1234);
+
+        // Transparent BytesHash + std::equal_to<> give string_view lookups
+        HashMap<std::string, int, BytesHash, std::equal_to<>> routes;
+        routes.insert("/api/users", 1);
+        assert(routes.find(std::string_view("/api/users")) && routes.at("/api/users") == 1);
+        assert(routes.erase(std::string_view("/api/users")) && routes.empty());
+
+        HashMap<uint64_t, uint64_t, IntHash> ids;
+        for (uint64_t id = 0; id < 10000; id++) ids.insert(id << 20, id);
+        for (uint64_t id = 0; id < 10000; id++) assert(ids.at(id << 20) == id);
+
+        // Hasher instances are passed in and copied with the map
+        HashMap<std::string, int, SeededHash> seeded(16, SeededHash{ 42 });
+        seeded.insert("a", 1);
+        HashMap<std::string, int, SeededHash> seededCopy = seeded;
+        assert(seeded.hash_function().seed == 42 && seededCopy.hash_function().seed == 42 && seededCopy.at("a") == 1);
+        HashMap<std::string, int, SeededHash> pooled(16, SeededHash{ 7 }, std::equal_to<std::string>(), seeded.pool());
+        pooled.insert("b", 2);
+        assert(pooled.pool() == seeded.pool() && pooled.hash_function().seed == 7);
+    }
+
+    // ===== Test find_batch and insert_batch =====
+    {
+        HashMap<std::string, int> hm;
+        std::vector<std::string> keys;
+        std::vector<int> values;
+        for (int i = 0; i < 1000; i++) {
+            keys.push_back("key" + std::to_string(i % 700)); // the last 300 repeat earlier keys
+            values.push_back(i);
+        }
+        hm.insert_batch(keys.data(), values.data(), keys.size());
+        assert(hm.size() == 700 && hm.at("key5") == 705 && hm.at("key699") == 699); // later values win
+
+        std::vector<std::string> probes = { "key0", "missing", "key699", "key700" };
+        for (int i = 0; i < 40; i++) probes.push_back("key" + std::to_string(i * 17));
+        std::vector<HashMap<std::string, int>::node_t*> found(probes.size());
+        hm.find_batch(probes.data(), probes.size(), found.data());
+        for (size_t i = 0; i < probes.size(); i++) assert(found[i] == hm.find(probes[i]));
+        assert(found[0]->getValue() == 700 && !found[1] && found[2] && !found[3]);
+
+        hm.find_batch(probes.data(), 0, found.data()); // empty batch is a no-op
+        hm.insert_batch(keys.data(), values.data(), 0);
+        assert(hm.size() == 700);
+
+        // Mid incremental rehash: entries in either table are found
+        HashMap<int, int> split(16);
+        split.rehash_step(1);
+        std::vector<int> ids(100), squares(100);
+        for (int i = 0; i < 100; i++) { ids[i] = i; squares[i] = i * i; }
+        for (int i = 0; i < 40; i++) split.insert(i, i * i);
+        assert(split.rehashing());
+        std::vector<HashMap<int, int>::node_t*> nodes(100);
+        split.find_batch(ids.data(), ids.size(), nodes.data());
+        for (int i = 0; i < 100; i++) assert((nodes[i] != nullptr) == (i < 40) && (!nodes[i] || nodes[i]->getValue() == i * i));
+        split.insert_batch(ids.data(), squares.data(), ids.size());
+        assert(split.size() == 100 && split.at(99) == 9801);
+    }
+
+    // ===== Test HashMap::save and FrozenHashMap =====
+    {
+        const std::string path = "pstl_frozen_map.test";
+        HashMap<uint64_t, uint64_t> source;
+        for (uint64_t i = 0; i < 100000; i++) source.insert(i * 7, i);
+        source.save(path);
+
+        FrozenHashMap<uint64_t, uint64_t> frozen(path);
+        assert(frozen.is_open() && frozen.size() == 100000 && !frozen.empty());
+        for (uint64_t i = 0; i < 100000; i++) assert(frozen.at(i * 7) == i);
+        assert(!frozen.find(1) && !frozen.contains(700001) && frozen.find(70)->getValue() == 10);
+        bool frozenThrew = false;
+        try { (void)frozen.at(3); }
+        catch (const std::out_of_range&) { frozenThrew = true; }
+        assert(frozenThrew);
+        uint64_t sum = 0;
+        for (const auto& entry : frozen) sum += entry.getValue();
+        assert(sum == 99999ull * 100000 / 2);
+
+        FrozenHashMap<uint64_t, uint64_t> moved = std::move(frozen);
+        assert(!frozen.is_open() && !frozen.contains(7) && moved.at(7) == 1);
+
+#ifndef _WIN32
+        // Saving over a mapped image replaces the file; the old mapping keeps its contents
+        HashMap<uint64_t, uint64_t> replacement = { {1, 2} };
+        replacement.save(path);
+        assert(moved.size() == 100000 && moved.at(7) == 1);
+        FrozenHashMap<uint64_t, uint64_t> reopened(path);
+        assert(reopened.size() == 1 && reopened.at(1) == 2);
+#endif
+        moved.close();
+
+        // Empty map, and a map saved mid incremental rehash
+        HashMap<uint64_t, uint64_t>().save(path);
+        moved.open(path);
+        assert(moved.empty() && !moved.contains(0));
+
+        IncrementalHashMap split(16);
+        for (int i = 0; i < 40; i++) split.insert(i, -i);
+        assert(split.rehashing());
+        split.save(path);
+        FrozenHashMap<int, int> frozenSplit(path);
+        assert(frozenSplit.size() == 40);
+        for (int i = 0; i < 40; i++) assert(frozenSplit.at(i) == -i);
+
+        // Wrong key type, wrong hasher, missing and corrupt files are rejected
+        HashMap<uint64_t, uint32_t, IntHash> hashed;
+        for (uint32_t i = 0; i < 1000; i++) hashed.insert(i, i + 1);
+        hashed.save(path);
+        assert((FrozenHashMap<uint64_t, uint32_t, IntHash>(path).at(999) == 1000));
+        auto rejects = [&](auto open) {
+            try { open(); }
+            catch (const std::runtime_error&) { return true; }
+            return false;
+        };
+        assert(rejects([&] { FrozenHashMap<uint64_t, uint32_t> wrongHash(path); }));
+        assert(rejects([&] { FrozenHashMap<uint64_t, uint64_t, IntHash> wrongType(path); }));
+        assert(rejects([&] { FrozenHashMap<uint64_t, uint64_t> missing("pstl_no_such_file.test"); }));
+        {
+            // Corrupt interior offsets (past the end, then decreasing) open, and lookups stay inside the entries
+            std::fstream image(path, std::ios::binary | std::ios::in | std::ios::out);
+            uint64_t bad[2] = { 1ull << 40, 0 };
+            image.seekp(static_cast<std::streamoff>(snapshot::offsetsOffset<uint64_t, uint32_t>(1000) + sizeof(uint64_t)));
+            image.write(reinterpret_cast<const char*>(bad), sizeof(bad));
+        }
+        FrozenHashMap<uint64_t, uint32_t, IntHash> damaged(path);
+        size_t stillFound = 0;
+        for (uint64_t i = 0; i < 2000; i++) stillFound += damaged.contains(i);
+        assert(stillFound <= 1000);
+        damaged.close();
+        { std::ofstream garbage(path, std::ios::binary | std::ios::trunc); garbage << std::string(200, 'x'); }
+        assert(rejects([&] { FrozenHashMap<uint64_t, uint64_t> corrupt(path); }));
+        std::remove(path.c_str());
+    }
+
+    // ===== Test PerfectHashMap =====
+    {
+        PerfectHashMap<std::string, int> fields = { {"Host", 0}, {"Accept", 1}, {"Content-Length", 2}, {"Content-Type", 3}, {"Cookie", 4} };
+        assert(fields.size() == 5 && fields.at("Content-Type") == 3 && fields.find("Cookie")->getValue() == 4);
+        assert(!fields.find("cookie") && !fields.contains("") && fields.index_of("Referer") == fields.npos);
+        std::bitset<5> seenSlots;
+        for (const auto& entry : fields) {
+            size_t slot = fields.index_of(entry.getKey());
+            assert(fields.begin()[slot].getValue() == entry.getValue());
+            seenSlots.set(slot);
+        }
+        assert(seenSlots.all()); // minimal: n keys, n slots
+        bool perfectThrew = false;
+        try { (void)fields.at("Accept-Encoding"); }
+        catch (const std::out_of_range&) { perfectThrew = true; }
+        assert(perfectThrew);
+
+        // Every small size, where few slots leave little room for displacement
+        for (int n = 1; n <= 64; n++) {
+            std::vector<std::pair<int, int>> pairs;
+            for (int i = 0; i < n; i++) pairs.emplace_back(i * 31, i);
+            PerfectHashMap<int, int> small(pairs.begin(), pairs.end());
+            for (int i = 0; i < n; i++) assert(small.at(i * 31) == i);
+            assert(!small.contains(1) && !small.contains(n * 31));
+        }
+
+        // From a HashMap, adopting its hasher
+        HashMap<uint64_t, uint64_t, IntHash> source;
+        for (uint64_t i = 0; i < 20000; i++) source.insert(i * i, i);
+        PerfectHashMap<uint64_t, uint64_t, IntHash> squares(source);
+        assert(squares.size() == 20000);
+        for (uint64_t i = 0; i < 20000; i++) assert(squares.at(i * i) == i && squares.index_of(i * i) < 20000);
+        for (uint64_t i = 2; i < 20000; i++) assert(!squares.contains(i * i + 1));
+
+        // Transparent lookup, empty map and duplicate keys
+        PerfectHashMap<std::string, int, BytesHash, std::equal_to<>> named = { {"alpha", 1}, {"beta", 2} };
+        assert(named.find(std::string_view("beta"))->getValue() == 2 && !named.find("gamma"));
+        PerfectHashMap<int, int> none;
+        assert(none.empty() && !none.contains(0) && none.begin() == none.end());
+        using IntPerfect = PerfectHashMap<int, int>;
+        assert(IntPerfect(HashMap<int, int>()).empty());
+        bool duplicate = false;
+        try { PerfectHashMap<int, int> twice = { {1, 1}, {2, 2}, {1, 3} }; }
+        catch (const std::invalid_argument&) { duplicate = true; }
+        assert(duplicate);
+
+        // Built at compile time
+        constexpr auto methods = make_perfect_hash_map<std::string_view, int>({ {"GET", 0}, {"HEAD", 1}, {"POST", 2}, {"PUT", 3}, {"DELETE", 4}, {"OPTIONS", 5} });
+        static_assert(methods.size() == 6 && methods.at("POST") == 2 && methods.at("OPTIONS") == 5, "compile-time lookup");
+        static_assert(!methods.contains("PATCH") && !methods.contains("get") && methods.index_of("TRACE") == methods.npos, "compile-time miss");
+        std::string runtimeKey = "DELETE";
+        assert(methods.at(runtimeKey) == 4 && methods.find(runtimeKey)->getKey() == "DELETE");
+
+        constexpr auto cubes = [] {
+            std::pair<int, long long> entries[300] = {};
+            for (int i = 0; i < 300; i++) {
+                entries[i].first = i - 150;
+                entries[i].second = static_cast<long long>(i - 150) * (i - 150) * (i - 150);
+            }
+            return StaticPerfectHashMap<int, long long, 300>(entries);
+        }();
+        static_assert(cubes.at(-150) == -3375000 && cubes.at(149) == 3307949 && !cubes.contains(150), "compile-time integers");
+        for (int i = -150; i < 150; i++) assert(cubes.at(i) == static_cast<long long>(i) * i * i);
+    }
+
+    // ===== Test LruCache =====
+    {
+        std::vector<int> evicted;
+        LruCache<int, int> lru(3, [&](const int& key, int&) { evicted.push_back(key); });
+        ClockCache<int, int> clock(3, [&](const int& key, int&) { evicted.push_back(-key); });
+        for (int key = 1; key <= 3; key++) {
+            assert(lru.put(key, key * 10) && clock.put(key, key * 10));
+        }
+        assert(*lru.get(1) == 10 && *clock.get(1) == 10);
+        lru.put(4, 40);
+        clock.put(4, 40);   // 1 is oldest but referenced: 2 goes instead
+        assert((evicted == std::vector<int>{ 2, -2 }));
+        assert(lru.get(3) && clock.get(3));
+        lru.put(5, 50);     // LRU order 5 3 4 1: 1 goes
+        clock.put(5, 50);   // only 3 is referenced; 4 is the oldest of the rest
+        assert((evicted == std::vector<int>{ 2, -2, 1, -4 }));
+        assert(lru.contains(3) && lru.contains(4) && !lru.contains(1) && clock.contains(1) && !clock.contains(4));
+        assert(!lru.get(2) && lru.size() == 3 && lru.usage() == 3);
+
+        const CacheStats& lruStats = lru.stats();
+        assert(lruStats.hits == 2 && lruStats.misses == 1 && lruStats.insertions == 5 && lruStats.evictions == 2);
+        assert(lruStats.hit_ratio() > 0.66 && lruStats.hit_ratio() < 0.67);
+
+        // Overwrite counts as a use; peek neither uses nor counts
+        assert(!lru.put(4, 44) && *lru.peek(4) == 44 && *lru.peek(3) == 30 && lru.stats().hits == 2);
+        lru.put(6, 60);     // order 4 5 3 before: 3 goes
+        assert(!lru.contains(3) && *lru.get(4) == 44);
+
+        // erase, clear and set_capacity; only budget evictions reach the callback
+        evicted.clear();
+        assert(lru.erase(5) && !lru.erase(5) && lru.size() == 2 && evicted.empty());
+        lru.put(7, 70);
+        lru.set_capacity(1);
+        assert(lru.size() == 1 && lru.contains(7) && (evicted == std::vector<int>{ 6, 4 }));
+        assert(!lru.put(8, 80, 2) && lru.contains(7));          // charged over capacity: never cached
+        assert(!lru.put(7, 71, 2) && !lru.contains(7) && lru.empty() && lru.usage() == 0);
+        lru.set_capacity(3);
+        lru.put(9, 90);
+        lru.clear();
+        assert(lru.empty() && lru.usage() == 0 && !lru.get(9) && evicted.size() == 2);
+        lru.reset_stats();
+        assert(lru.stats().hits == 0 && lru.stats().misses == 0);
+
+        // Byte budget: the callback may take the value it is handed
+        std::vector<std::string> spilled;
+        LruCache<std::string, std::string> pages(16, [&](const std::string&, std::string& page) { spilled.push_back(std::move(page)); });
+        pages.put("a", std::string(6, 'a'), 6);
+        pages.put("b", std::string(6, 'b'), 6);
+        pages.put("c", std::string(4, 'c'), 4);
+        assert(pages.size() == 3 && pages.usage() == 16 && spilled.empty());
+        pages.get("a");
+        pages.put("d", std::string(8, 'd'), 8);             // b, then c, to free 8 bytes
+        assert(pages.usage() == 14 && pages.contains("a") && !pages.contains("b") && !pages.contains("c"));
+        assert(spilled.size() == 2 && spilled[0] == "bbbbbb" && spilled[1] == "cccc");
+        pages.put("a", std::string(12, 'A'), 12);           // growing in place evicts d, never a itself
+        assert(pages.size() == 1 && pages.usage() == 12 && *pages.get("a") == std::string(12, 'A'));
+
+        // CLOCK never evicts the entry being put, even when all others are referenced
+        ClockCache<int, int> hot(4);
+        for (int key = 0; key < 4; key++) hot.put(key, key);
+        for (int key = 0; key < 4; key++) hot.get(key);
+        hot.put(4, 4, 3);
+        assert(hot.contains(4) && hot.usage() <= 4 && hot.size() == 2);
+
+        // Random workload against a plain std::list LRU
+        std::mt19937 rng(25);
+        LruCache<int, int> model(40);
+        std::vector<int> order;     // most recent first
+        std::unordered_map<int, std::pair<int, size_t>> ref;
+        size_t refUsage = 0;
+        auto touch = [&](int key) {
+            order.erase(std::find(order.begin(), order.end(), key));
+            order.insert(order.begin(), key);
+        };
+        for (int op = 0; op < 20000; op++) {
+            int key = static_cast<int>(rng() % 100);
+            if (rng() % 2) {
+                int* value = model.get(key);
+                auto it = ref.find(key);
+                assert((value != nullptr) == (it != ref.end()));
+                if (value) {
+                    assert(*value == it->second.first);
+                    touch(key);
+                }
+            }
+            else {
+                size_t charge = 1 + rng() % 3;
+                model.put(key, op, charge);
+                auto it = ref.find(key);
+                if (it != ref.end()) {
+                    refUsage -= it->second.second;
+                    it->second = { op, charge };
+                    touch(key);
+                }
+                else {
+                    ref[key] = { op, charge };
+                    order.insert(order.begin(), key);
+                }
+                refUsage += charge;
+                while (refUsage > 40) {
+                    refUsage -= ref[order.back()].second;
+                    ref.erase(order.back());
+                    order.pop_back();
+                }
+            }
+            assert(model.size() == ref.size() && model.usage() == refUsage);
+        }
+
+        // Sharded: concurrent gets and puts stay within budget and count every lookup
+        auto hammer = [](auto& cache) {
+            std::atomic<uint64_t> lookups{ 0 };
+            std::vector<std::thread> threads;
+            for (int t = 0; t < 4; t++) {
+                threads.emplace_back([&cache, &lookups, t] {
+                    std::mt19937 local(t);
+                    for (int op = 0; op < 20000; op++) {
+                        int key = static_cast<int>(local() % 2000);
+                        auto value = cache.get(key);
+                        lookups.fetch_add(1, std::memory_order_relaxed);
+                        if (value)
+                            assert(*value == key * 2);
+                        else
+                            cache.put(key, key * 2);
+                    }
+                });
+            }
+            for (auto& thread : threads) thread.join();
+            return lookups.load();
+        };
+        std::atomic<uint64_t> shardedEvictions{ 0 };
+        ShardedCache<ClockCache<int, int>> shardedClock(1000, 8, [&](const int&, int&) { shardedEvictions++; });
+        ShardedCache<LruCache<int, int>> shardedLru(1000, 8);
+        assert(shardedClock.shard_count() == 8 && shardedClock.capacity() == 1000);
+        uint64_t clockLookups = hammer(shardedClock);
+        uint64_t lruLookups = hammer(shardedLru);
+        CacheStats clockStats = shardedClock.stats();
+        CacheStats lruShardStats = shardedLru.stats();
+        assert(clockStats.hits + clockStats.misses == clockLookups && clockStats.hits > 0);
+        assert(lruShardStats.hits + lruShardStats.misses == lruLookups && lruShardStats.hits > 0);
+        assert(clockStats.evictions == shardedEvictions && clockStats.insertions - clockStats.evictions == shardedClock.size());
+        assert(shardedClock.size() <= 1000 && shardedLru.usage() <= 1000 && shardedLru.size() == shardedLru.usage());
+        assert(shardedClock.put(5000, 1) && *shardedClock.get(5000) == 1 && shardedClock.erase(5000) && !shardedClock.contains(5000));
+        shardedClock.clear();
+        shardedClock.reset_stats();
+        assert(shardedClock.empty() && shardedClock.stats().hits == 0 && !shardedClock.get(1));
+    }
+
+    // ===== Test ConcurrentHashMap =====
+    {
+        ConcurrentHashMap<std::string, int> names(3);
+        assert(names.shard_count() == 4 && names.empty());
+        assert(names.insert("one", 1) && !names.insert("one", 11));
+        assert(names.try_emplace("two", 2) && !names.try_emplace("two", 22));
+        assert(names.at("one") == 11 && *names.find("two") == 2 && !names.find("three"));
+        assert(names.contains("two") && !names.contains("three"));
+        assert(names.insert_or_update("three", [](int& v) { v += 3; }) && names.at("three") == 3);
+        assert(!names.insert_or_update("three", [](int& v) { v *= 10; }) && names.at("three") == 30);
+        assert(names.erase("one") && !names.erase("one") && names.size() == 2);
+
+        bool threw = false;
+        try { names.at("one"); }
+        catch (const std::out_of_range&) { threw = true; }
+        assert(threw);
+
+        ConcurrentHashMap<int, int> init = { {1, 10}, {2, 20} };
+        assert(init.size() == 2 && init.at(2) == 20);
+        init.clear();
+        assert(init.empty());
+
+        // Writers on disjoint ranges, a shared counter and concurrent readers
+        ConcurrentHashMap<int, int> cm(8, 1000);
+        const int threads = 8;
+        const int perThread = 5000;
+        std::atomic<bool> stop(false);
+        std::thread reader([&] {
+            while (!stop.load()) {
+                for (int k = 0; k < threads * perThread; k += 97) {
+                    auto value = cm.find(k);
+                    assert(!value || *value == k || *value == -k);
+                }
+            }
+        });
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([&, t] {
+                for (int i = 0; i < perThread; i++) {
+                    int key = t * perThread + i;
+                    cm.insert(key, key);
+                    cm.insert_or_update(-1, [](int& hits) { hits++; });
+                    if (i % 4 == 0) assert(cm.erase(key));
+                    else if (i % 4 == 1) cm.insert(key, -key);
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+        stop.store(true);
+        reader.join();
+
+        assert(cm.at(-1) == threads * perThread);
+        assert(cm.size() == static_cast<size_t>(threads * perThread * 3 / 4 + 1));
+
+        size_t seen = 0;
+        cm.for_each([&](const int& key, const int& value) {
+            if (key == -1) return;
+            assert(key % 4 != 0 || key % perThread % 4 != 0);
+            assert(value == (key % perThread % 4 == 1 ? -key : key));
+            seen++;
+        });
+        assert(seen == cm.size() - 1);
+    }
+
+    // ===== Test LockFreeReadHashMap =====
+    {
+        LockFreeReadHashMap<std::string, int> lf(2);
+        assert(lf.empty() && lf.bucket_count() == 2);
+        assert(lf.insert("a", 1) && lf.insert("b", 2) && lf.insert("c", 3)); // grows past 2 buckets
+        assert(lf.size() == 3 && lf.bucket_count() == 4);
+        assert(!lf.insert("a", 10) && lf.size() == 3);
+        assert(lf.at("a") == 10 && *lf.find("b") == 2 && !lf.find("z") && lf.contains("c"));
+
+        int seen = 0;
+        assert(lf.visit("c", [&](const int& v) { seen = v; }) && seen == 3);
+        assert(!lf.visit("z", [&](const int&) { seen = -1; }) && seen == 3);
+
+        bool threw = false;
+        try { lf.at("z"); }
+        catch (const std::out_of_range&) { threw = true; }
+        assert(threw);
+
+        assert(lf.erase("b") && !lf.erase("b") && lf.size() == 2 && !lf.contains("b"));
+        lf.reserve(64);
+        assert(lf.bucket_count() == 64 && lf.at("c") == 3);
+
+        // Nothing is freed while a reader section that might hold it is open
+        {
+            epoch::Guard guard;
+            lf.erase("c");
+            lf.reclaim_now();
+            assert(lf.pending_reclaim() > 0);
+        }
+        lf.reclaim_now();
+        assert(lf.pending_reclaim() == 0);
+
+        lf.clear();
+        assert(lf.empty() && !lf.contains("a"));
+        LockFreeReadHashMap<int, int> init = { {1, 1}, {2, 4} };
+        assert(init.size() == 2 && init.at(2) == 4);
+
+        // Stress: readers check every value they see against its key while
+        // writers replace, erase, grow and clear underneath them
+        LockFreeReadHashMap<int, std::string> routes(4);
+        const int keys = 2000;
+        std::atomic<bool> stop(false);
+        std::atomic<long long> reads(0);
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 4; r++) {
+            readers.emplace_back([&, r] {
+                long long local = 0;
+                while (!stop.load()) {
+                    for (int k = r; k < keys; k += 7) {
+                        auto value = routes.find(k);
+                        assert(!value || value->compare(0, std::to_string(k).size() + 1, std::to_string(k) + ":") == 0);
+                        routes.visit(k, [&](const std::string& v) { assert(v[0] == std::to_string(k)[0]); });
+                        local++;
+                    }
+                }
+                reads += local;
+            });
+        }
+        std::vector<std::thread> writers;
+        for (int w = 0; w < 2; w++) {
+            writers.emplace_back([&, w] {
+                std::mt19937 rng(w + 1);
+                for (int i = 0; i < 30000; i++) {
+                    int k = static_cast<int>(rng() % keys);
+                    if (rng() % 4 == 0) routes.erase(k);
+                    else routes.insert(k, std::to_string(k) + ":" + std::to_string(i));
+                    if (w == 0 && i % 10000 == 9999) routes.clear();
+                }
+            });
+        }
+        for (auto& t : writers) t.join();
+        stop.store(true);
+        for (auto& t : readers) t.join();
+
+        assert(reads.load() > 0);
+        for (int k = 0; k < keys; k++) {
+            auto value = routes.find(k);
+            assert(!value || value->compare(0, std::to_string(k).size() + 1, std::to_string(k) + ":") == 0);
+        }
+        routes.reclaim_now();
+        assert(routes.pending_reclaim() == 0);
+    }
+
+#ifdef PSTL_BENCHMARK
+    benchMaps();
+#endif
+
     std::cout << "All tests passed successfully.\n";
 }
\ No newline at end of file
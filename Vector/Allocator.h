@@ -0,0 +1,265 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#endif
+
+/*
+* Allocators usable as the second template parameter of pSTL::Vector.
+* Both satisfy the standard Allocator requirements, so they also work with
+* std containers. On top of that they may provide the optional hook
+*
+*     bool expand(T* ptr, size_t oldCount, size_t newCount);
+*
+* which grows an existing block in place. Vector tries it before falling
+* back to allocate + relocate + deallocate
+*/
+
+namespace pSTL {
+	/********************** Arena **********************/
+
+	// Monotonic bump allocator: individual frees are no-ops and everything
+	// is returned at once by release() or the destructor. Meant for
+	// request-scoped containers that all die together
+	class Arena {
+	public:
+		explicit Arena(size_t chunkSize = 64 * 1024)
+			: m_chunkSize(chunkSize ? chunkSize : 1), m_head(nullptr), m_cursor(nullptr), m_end(nullptr),
+			m_last(nullptr), m_used(0) {
+		}
+
+		Arena(const Arena&) = delete;
+		Arena& operator=(const Arena&) = delete;
+
+		~Arena() {
+			release();
+		}
+
+		void* allocate(size_t bytes, size_t alignment) {
+			char* ptr = alignUp(m_cursor, alignment);
+			if (!m_cursor || ptr > m_end || bytes > static_cast<size_t>(m_end - ptr)) {
+				newChunk(bytes + alignment);
+				ptr = alignUp(m_cursor, alignment);
+			}
+
+			m_cursor = ptr + bytes;
+			m_last = ptr;
+			m_used += bytes;
+			return ptr;
+		}
+
+		// Only the most recent allocation can grow, and only into the rest of its chunk
+		bool expand(void* ptr, size_t oldBytes, size_t newBytes) noexcept {
+			char* p = static_cast<char*>(ptr);
+			if (p != m_last || p + oldBytes != m_cursor) return false;
+			if (newBytes > static_cast<size_t>(m_end - p)) return false;
+
+			m_cursor = p + newBytes;
+			m_used += newBytes - oldBytes;
+			return true;
+		}
+
+		void release() noexcept {
+			while (m_head) {
+				Chunk* next = m_head->next;
+				::operator delete(m_head);
+				m_head = next;
+			}
+			m_cursor = m_end = m_last = nullptr;
+			m_used = 0;
+		}
+
+		size_t bytes_used() const noexcept { return m_used; }
+
+	private:
+		struct alignas(std::max_align_t) Chunk {
+			Chunk* next;
+		};
+
+		static char* alignUp(char* ptr, size_t alignment) noexcept {
+			std::uintptr_t value = reinterpret_cast<std::uintptr_t>(ptr);
+			value = (value + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1);
+			return reinterpret_cast<char*>(value);
+		}
+
+		void newChunk(size_t minBytes) {
+			size_t bytes = minBytes > m_chunkSize ? minBytes : m_chunkSize;
+			Chunk* chunk = static_cast<Chunk*>(::operator new(sizeof(Chunk) + bytes));
+			chunk->next = m_head;
+			m_head = chunk;
+
+			m_cursor = reinterpret_cast<char*>(chunk + 1);
+			m_end = m_cursor + bytes;
+		}
+
+		size_t m_chunkSize;
+		Chunk* m_head;
+		char* m_cursor;
+		char* m_end;
+		char* m_last;
+		size_t m_used;
+	};
+
+	template <typename T>
+	class ArenaAllocator {
+	public:
+		using value_type = T;
+
+		explicit ArenaAllocator(Arena& arena) noexcept
+			: m_arena(&arena) {
+		}
+
+		template <typename U>
+		ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+			: m_arena(other.arena()) {
+		}
+
+		T* allocate(size_t count) {
+			return static_cast<T*>(m_arena->allocate(count * sizeof(T), alignof(T)));
+		}
+
+		void deallocate(T*, size_t) noexcept {
+		}
+
+		bool expand(T* ptr, size_t oldCount, size_t newCount) noexcept {
+			return m_arena->expand(ptr, oldCount * sizeof(T), newCount * sizeof(T));
+		}
+
+		Arena* arena() const noexcept { return m_arena; }
+
+	private:
+		Arena* m_arena;
+	};
+
+	template <typename T, typename U>
+	bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) noexcept {
+		return a.arena() == b.arena();
+	}
+	template <typename T, typename U>
+	bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) noexcept {
+		return !(a == b);
+	}
+
+
+	/********************** HugePageAllocator **********************/
+
+	// For multi-GB buffers: blocks of at least LargeThreshold bytes are mapped
+	// directly from the OS, on 2 MiB pages when the system grants them
+	// (MAP_HUGETLB / MEM_LARGE_PAGES) and otherwise hinted for transparent
+	// huge pages. Smaller blocks are cache-line aligned heap allocations
+	template <typename T>
+	class HugePageAllocator {
+	public:
+		using value_type = T;
+
+		static constexpr size_t HugePageSize = 2 * 1024 * 1024;
+		static constexpr size_t LargeThreshold = HugePageSize;
+		static constexpr size_t SmallAlignment = alignof(T) > 64 ? alignof(T) : 64;
+
+		HugePageAllocator() noexcept = default;
+
+		template <typename U>
+		HugePageAllocator(const HugePageAllocator<U>&) noexcept {
+		}
+
+		T* allocate(size_t count) {
+			size_t bytes = count * sizeof(T);
+			if (bytes < LargeThreshold) {
+				return static_cast<T*>(::operator new(bytes, std::align_val_t(SmallAlignment)));
+			}
+			return static_cast<T*>(mapPages(roundUp(bytes)));
+		}
+
+		void deallocate(T* ptr, size_t count) noexcept {
+			size_t bytes = count * sizeof(T);
+			if (bytes < LargeThreshold) {
+				::operator delete(ptr, std::align_val_t(SmallAlignment));
+				return;
+			}
+			unmapPages(ptr, roundUp(bytes));
+		}
+
+		// Mapped blocks are rounded up to whole huge pages, so growth within the
+		// last page is free; beyond that Linux can often extend the mapping in place
+		bool expand(T* ptr, size_t oldCount, size_t newCount) noexcept {
+			size_t oldBytes = oldCount * sizeof(T);
+			size_t newBytes = newCount * sizeof(T);
+			if (oldBytes < LargeThreshold) return false;
+			if (roundUp(newBytes) == roundUp(oldBytes)) return true;
+
+#if defined(__linux__)
+			void* res = ::mremap(ptr, roundUp(oldBytes), roundUp(newBytes), 0);
+			return res != MAP_FAILED;
+#else
+			(void)ptr;
+			return false;
+#endif
+		}
+
+	private:
+		static size_t roundUp(size_t bytes) noexcept {
+			return (bytes + HugePageSize - 1) & ~(HugePageSize - 1);
+		}
+
+		static void* mapPages(size_t bytes) {
+#if defined(_WIN32)
+			void* ptr = nullptr;
+			size_t largePage = ::GetLargePageMinimum();
+			if (largePage && bytes % largePage == 0) {
+				ptr = ::VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+			}
+			if (!ptr) {
+				ptr = ::VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+			}
+			if (!ptr) throw std::bad_alloc();
+			return ptr;
+#elif defined(__unix__) || defined(__APPLE__)
+			void* ptr = MAP_FAILED;
+#if defined(MAP_HUGETLB)
+			ptr = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+			if (ptr == MAP_FAILED) {
+				ptr = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+				if (ptr == MAP_FAILED) throw std::bad_alloc();
+#if defined(MADV_HUGEPAGE)
+				::madvise(ptr, bytes, MADV_HUGEPAGE);
+#endif
+			}
+			return ptr;
+#else
+			return ::operator new(bytes, std::align_val_t(HugePageSize));
+#endif
+		}
+
+		static void unmapPages(void* ptr, size_t bytes) noexcept {
+#if defined(_WIN32)
+			(void)bytes;
+			::VirtualFree(ptr, 0, MEM_RELEASE);
+#elif defined(__unix__) || defined(__APPLE__)
+			::munmap(ptr, bytes);
+#else
+			(void)bytes;
+			::operator delete(ptr, std::align_val_t(HugePageSize));
+#endif
+		}
+	};
+
+	template <typename T, typename U>
+	bool operator==(const HugePageAllocator<T>&, const HugePageAllocator<U>&) noexcept {
+		return true;
+	}
+	template <typename T, typename U>
+	bool operator!=(const HugePageAllocator<T>&, const HugePageAllocator<U>&) noexcept {
+		return false;
+	}
+}
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <stdexcept>
+#include <utility>
+#include <memory>
+#include <new>
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace pSTL {
+	// Append-only vector for many concurrent producers.
+	//
+	// push_back/emplace_back/grow_by claim slots with a single atomic
+	// fetch-add and construct into segments that are never moved or freed
+	// while the container lives. Segment k holds 2^(FirstShift + k) slots,
+	// so the segment table is a fixed array and indexing is a bit scan.
+	// Missing segments are allocated by whichever thread needs them first
+	// and published with a CAS; the loser frees its copy. No locks anywhere.
+	//
+	// Readers may access index i concurrently with appends once i is
+	// published: either the pushing thread handed i over (queue, join, ...)
+	// or is_published(i) returned true. size() counts claimed slots, some of
+	// which may still be under construction.
+	//
+	// clear() and destruction require that no other thread uses the
+	// container at the same time.
+	template <typename T, size_t FirstShift = 8>
+	class ConcurrentVector {
+		static_assert(FirstShift < 32, "ConcurrentVector: first segment too large");
+
+	public:
+		static constexpr size_t first_segment_size = static_cast<size_t>(1) << FirstShift;
+		static constexpr size_t max_segments = sizeof(size_t) * 8 - FirstShift;
+
+
+		/********************** Constructors **********************/
+
+		ConcurrentVector() noexcept
+			: m_size(0) {
+			for (auto& segment : m_segments) segment.store(nullptr, std::memory_order_relaxed);
+		}
+
+		ConcurrentVector(const ConcurrentVector&) = delete;
+		ConcurrentVector& operator=(const ConcurrentVector&) = delete;
+
+		~ConcurrentVector() {
+			clear();
+			for (size_t k = 0; k < max_segments; k++) {
+				char* segment = m_segments[k].load(std::memory_order_relaxed);
+				if (segment) deallocateSegment(segment, k);
+			}
+		}
+
+
+		/********************** Getters **********************/
+
+		T& operator[](size_t index) {
+			return *slot(index);
+		}
+		const T& operator[](size_t index) const {
+			return *slot(index);
+		}
+
+		T& at(size_t index) {
+			if (!is_published(index)) throw std::out_of_range("Out of bound access!");
+			return *slot(index);
+		}
+		const T& at(size_t index) const {
+			if (!is_published(index)) throw std::out_of_range("Out of bound access!");
+			return *slot(index);
+		}
+
+		// True once the element at index is fully constructed and visible
+		bool is_published(size_t index) const noexcept {
+			if (index >= size()) return false;
+
+			size_t k = segmentOf(index);
+			char* segment = m_segments[k].load(std::memory_order_acquire);
+			if (!segment) return false;
+			return readyFlags(segment, k)[index - segmentBase(k)].load(std::memory_order_acquire) != 0;
+		}
+
+		size_t size() const noexcept { return m_size.load(std::memory_order_acquire); }
+		bool empty() const noexcept { return size() == 0; }
+
+
+		/********************** Setters **********************/
+
+		size_t push_back(const T& val) {
+			return emplace_back(val);
+		}
+		size_t push_back(T&& val) {
+			return emplace_back(std::move(val));
+		}
+
+		// Returns the index the element was stored at
+		template <typename... Args>
+		size_t emplace_back(Args&&... args) {
+			size_t index = m_size.fetch_add(1, std::memory_order_relaxed);
+			size_t k = segmentOf(index);
+			char* segment = ensureSegment(k);
+
+			size_t offset = index - segmentBase(k);
+			::new (static_cast<void*>(elements(segment) + offset)) T(std::forward<Args>(args)...);
+			readyFlags(segment, k)[offset].store(1, std::memory_order_release);
+			return index;
+		}
+
+		// Claims count consecutive slots in one atomic step and constructs
+		// them from args. Returns the first index of the batch
+		template <typename... Args>
+		size_t grow_by(size_t count, const Args&... args) {
+			size_t first = m_size.fetch_add(count, std::memory_order_relaxed);
+			if (count == 0) return first;
+
+			size_t last = first + count - 1;
+			for (size_t k = segmentOf(first); k <= segmentOf(last); k++) ensureSegment(k);
+
+			for (size_t index = first; index <= last; index++) {
+				size_t k = segmentOf(index);
+				char* segment = m_segments[k].load(std::memory_order_acquire);
+				size_t offset = index - segmentBase(k);
+				::new (static_cast<void*>(elements(segment) + offset)) T(args...);
+				readyFlags(segment, k)[offset].store(1, std::memory_order_release);
+			}
+			return first;
+		}
+
+		// Not thread-safe. Destroys all elements, keeps the segments
+		void clear() noexcept {
+			size_t count = m_size.load(std::memory_order_relaxed);
+			for (size_t k = 0; k < max_segments && segmentBase(k) < count; k++) {
+				char* segment = m_segments[k].load(std::memory_order_relaxed);
+				if (!segment) continue;
+
+				T* items = elements(segment);
+				std::atomic<unsigned char>* ready = readyFlags(segment, k);
+				size_t used = count - segmentBase(k);
+				if (used > segmentSize(k)) used = segmentSize(k);
+				for (size_t i = 0; i < used; i++) {
+					if (ready[i].load(std::memory_order_relaxed)) {
+						std::destroy_at(items + i);
+						ready[i].store(0, std::memory_order_relaxed);
+					}
+				}
+			}
+			m_size.store(0, std::memory_order_relaxed);
+		}
+
+	private:
+		/********************** Segments **********************/
+
+		static size_t floorLog2(size_t x) noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+			unsigned long index;
+#if defined(_WIN64)
+			_BitScanReverse64(&index, x);
+#else
+			_BitScanReverse(&index, static_cast<unsigned long>(x));
+#endif
+			return index;
+#else
+			return sizeof(unsigned long long) * 8 - 1 - static_cast<size_t>(__builtin_clzll(x));
+#endif
+		}
+
+		static size_t segmentOf(size_t index) noexcept {
+			return floorLog2((index >> FirstShift) + 1);
+		}
+		static size_t segmentBase(size_t k) noexcept {
+			return first_segment_size * ((static_cast<size_t>(1) << k) - 1);
+		}
+		static size_t segmentSize(size_t k) noexcept {
+			return first_segment_size << k;
+		}
+
+		// Segment layout: [T x size][ready flag x size]
+		static T* elements(char* segment) noexcept {
+			return reinterpret_cast<T*>(segment);
+		}
+		static std::atomic<unsigned char>* readyFlags(char* segment, size_t k) noexcept {
+			return reinterpret_cast<std::atomic<unsigned char>*>(segment + segmentSize(k) * sizeof(T));
+		}
+
+		static char* allocateSegment(size_t k) {
+			size_t count = segmentSize(k);
+			char* segment = static_cast<char*>(::operator new(count * (sizeof(T) + 1), std::align_val_t(alignof(T))));
+			std::atomic<unsigned char>* ready = readyFlags(segment, k);
+			for (size_t i = 0; i < count; i++) ::new (static_cast<void*>(ready + i)) std::atomic<unsigned char>(0);
+			return segment;
+		}
+
+		static void deallocateSegment(char* segment, size_t) noexcept {
+			::operator delete(segment, std::align_val_t(alignof(T)));
+		}
+
+		char* ensureSegment(size_t k) {
+			char* segment = m_segments[k].load(std::memory_order_acquire);
+			if (segment) return segment;
+
+			char* fresh = allocateSegment(k);
+			if (m_segments[k].compare_exchange_strong(segment, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+				return fresh;
+			}
+			deallocateSegment(fresh, k);
+			return segment;
+		}
+
+		T* slot(size_t index) const noexcept {
+			size_t k = segmentOf(index);
+			return elements(m_segments[k].load(std::memory_order_acquire)) + (index - segmentBase(k));
+		}
+
+		std::atomic<char*> m_segments[max_segments];
+		std::atomic<size_t> m_size;
+	};
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstddef>
+#include <atomic>
+
+/*
+* Growth policies for the third template parameter of pSTL::Vector.
+*
+* A policy provides
+*
+*     static size_t next(size_t capacity, size_t required, size_t elementSize);
+*
+* returning the capacity to grow to from `capacity` when at least
+* `required` slots are needed (always >= required). Policies may also
+* provide the optional hooks
+*
+*     static void onReallocate(size_t oldCapacity, size_t newCapacity, size_t bytesRelocated);
+*     static void onExpand(size_t oldCapacity, size_t newCapacity);
+*
+* which Vector calls after moving to a new buffer or growing in place.
+* InstrumentedGrowth adds them to any policy.
+*/
+
+namespace pSTL {
+	/********************** Policies **********************/
+
+	// capacity * 1.5, the historical Vector behaviour
+	struct GrowOneAndHalf {
+		static size_t next(size_t capacity, size_t required, size_t) noexcept {
+			size_t grown = capacity + capacity / 2 + 1;
+			return grown > required ? grown : required;
+		}
+	};
+
+	struct GrowDouble {
+		static size_t next(size_t capacity, size_t required, size_t) noexcept {
+			size_t grown = capacity ? capacity * 2 : 1;
+			return grown > required ? grown : required;
+		}
+	};
+
+	// Linear growth by a fixed number of elements. Keeps slack bounded for
+	// huge buffers at the price of O(n^2 / Chunk) total copying
+	template <size_t Chunk>
+	struct GrowFixedChunk {
+		static_assert(Chunk > 0, "GrowFixedChunk: chunk must be > 0");
+
+		static size_t next(size_t capacity, size_t required, size_t) noexcept {
+			size_t grown = capacity + Chunk;
+			if (grown >= required) return grown;
+			return required + (Chunk - required % Chunk) % Chunk;
+		}
+	};
+
+	// Doubles to a power of two, then rounds the byte size up to the
+	// malloc size class it will land in anyway (jemalloc layout: 16 byte
+	// steps up to 128, then four classes per power of two), so the slack
+	// the allocator would waste becomes usable capacity
+	struct GrowPowerOfTwo {
+		static size_t next(size_t capacity, size_t required, size_t elementSize) noexcept {
+			size_t target = capacity ? capacity * 2 : 1;
+			if (target < required) target = required;
+
+			size_t pow2 = 1;
+			while (pow2 < target) pow2 <<= 1;
+
+			size_t bytes = sizeClass(pow2 * elementSize);
+			return bytes / elementSize;
+		}
+
+		static size_t sizeClass(size_t bytes) noexcept {
+			if (bytes <= 8) return 8;
+			if (bytes <= 128) return (bytes + 15) & ~static_cast<size_t>(15);
+
+			size_t lg = 0;
+			for (size_t v = bytes - 1; v > 1; v >>= 1) lg++;
+			size_t spacing = static_cast<size_t>(1) << (lg - 2);
+			return (bytes + spacing - 1) & ~(spacing - 1);
+		}
+	};
+
+
+	/********************** Instrumentation **********************/
+
+	struct GrowthStats {
+		std::atomic<size_t> reallocations{ 0 };
+		std::atomic<size_t> expansions{ 0 };
+		std::atomic<size_t> bytesRelocated{ 0 };
+		std::atomic<size_t> peakCapacity{ 0 };
+
+		void reset() noexcept {
+			reallocations = 0;
+			expansions = 0;
+			bytesRelocated = 0;
+			peakCapacity = 0;
+		}
+	};
+
+	// Wraps Policy and records every growth event into one GrowthStats per
+	// Tag, shared by all vectors using this instantiation. Counters are
+	// relaxed atomics, so instrumented vectors may live on any thread:
+	//
+	//     using IdGrowth = InstrumentedGrowth<GrowDouble, struct IdTableTag>;
+	//     Vector<uint32_t, std::allocator<uint32_t>, IdGrowth> ids;
+	//     ... IdGrowth::stats().reallocations ...
+	template <typename Policy, typename Tag = void>
+	struct InstrumentedGrowth : Policy {
+		static GrowthStats& stats() noexcept {
+			static GrowthStats s;
+			return s;
+		}
+
+		static void onReallocate(size_t, size_t newCapacity, size_t bytesRelocated) noexcept {
+			GrowthStats& s = stats();
+			s.reallocations.fetch_add(1, std::memory_order_relaxed);
+			s.bytesRelocated.fetch_add(bytesRelocated, std::memory_order_relaxed);
+			notePeak(s, newCapacity);
+		}
+
+		static void onExpand(size_t, size_t newCapacity) noexcept {
+			GrowthStats& s = stats();
+			s.expansions.fetch_add(1, std::memory_order_relaxed);
+			notePeak(s, newCapacity);
+		}
+
+	private:
+		static void notePeak(GrowthStats& s, size_t capacity) noexcept {
+			size_t peak = s.peakCapacity.load(std::memory_order_relaxed);
+			while (capacity > peak && !s.peakCapacity.compare_exchange_weak(peak, capacity, std::memory_order_relaxed)) {
+			}
+		}
+	};
+}
@@ -0,0 +1,426 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "Vector.h"
+
+namespace pSTL {
+	// Vector of trivially copyable T whose buffer is a memory-mapped file.
+	//
+	// File layout: a 64 byte header (magic, element size, element count)
+	// followed by capacity() elements. Opening an existing file maps it and
+	// is ready immediately, no matter how large; pages are faulted in on
+	// first touch and shared with every other process mapping the file.
+	// reserve() grows the file (ftruncate / SetEndOfFile) and the mapping
+	// (mremap where available, otherwise unmap + map) in 64 KiB steps.
+	// sync() flushes dirty pages to disk; without it the OS writes them
+	// back on its own schedule.
+	//
+	// Growth moves the mapping, so like Vector it invalidates pointers.
+	// I/O failures throw std::runtime_error
+	template <typename T>
+	class MappedVector {
+		static_assert(std::is_trivially_copyable_v<T>, "MappedVector: T must be trivially copyable");
+
+	public:
+		/********************** Constructors **********************/
+
+		MappedVector() noexcept
+			: m_base(nullptr), m_size(0), m_capacity(0), m_mappedBytes(0), m_file(invalidFile()) {
+		}
+
+		// Opens path, creating an empty vector file if it does not exist
+		explicit MappedVector(const std::string& path)
+			: MappedVector() {
+			open(path);
+		}
+
+		MappedVector(const MappedVector&) = delete;
+		MappedVector& operator=(const MappedVector&) = delete;
+
+		MappedVector(MappedVector&& other) noexcept
+			: MappedVector() {
+			swap(other);
+		}
+
+		MappedVector& operator=(MappedVector&& other) noexcept {
+			if (this != &other) {
+				close();
+				swap(other);
+			}
+			return *this;
+		}
+
+		~MappedVector() {
+			close();
+		}
+
+
+		/********************** File **********************/
+
+		void open(const std::string& path) {
+			close();
+
+			bool created = false;
+			m_file = openFile(path, created);
+			try {
+				uint64_t fileBytes = fileSize();
+				if (created || fileBytes == 0) {
+					resizeFile(HeaderSize + GrowthGranularity);
+					map(HeaderSize + GrowthGranularity);
+					Header* h = header();
+					std::memcpy(h->magic, Magic, sizeof(h->magic));
+					h->elementSize = sizeof(T);
+					h->size = 0;
+				}
+				else {
+					if (fileBytes < HeaderSize) throw std::runtime_error("MappedVector: file too small for header");
+					map(static_cast<size_t>(fileBytes));
+
+					const Header* h = header();
+					if (std::memcmp(h->magic, Magic, sizeof(h->magic)) != 0) throw std::runtime_error("MappedVector: bad file magic");
+					if (h->elementSize != sizeof(T)) throw std::runtime_error("MappedVector: element size mismatch");
+				}
+
+				m_capacity = (m_mappedBytes - HeaderSize) / sizeof(T);
+				m_size = static_cast<size_t>(header()->size);
+				if (m_size > m_capacity) throw std::runtime_error("MappedVector: file truncated");
+			}
+			catch (...) {
+				close();
+				throw;
+			}
+		}
+
+		void close() noexcept {
+			if (m_base) unmap();
+			if (m_file != invalidFile()) closeFile();
+			m_size = 0;
+			m_capacity = 0;
+		}
+
+		bool is_open() const noexcept { return m_base != nullptr; }
+
+		// Blocks until all modified pages (and the header) are on disk
+		void sync() {
+			if (!m_base) return;
+#if defined(_WIN32)
+			if (!::FlushViewOfFile(m_base, 0) || !::FlushFileBuffers(m_file)) throw std::runtime_error("MappedVector: sync failed");
+#else
+			if (::msync(m_base, m_mappedBytes, MS_SYNC) != 0) throw std::runtime_error("MappedVector: sync failed");
+#endif
+		}
+
+
+		/********************** Getters **********************/
+
+		T& at(size_t index) {
+			if (index >= m_size) throw std::out_of_range("Out of bound access!");
+			return data()[index];
+		}
+		const T& at(size_t index) const {
+			if (index >= m_size) throw std::out_of_range("Out of bound access!");
+			return data()[index];
+		}
+
+		T& operator[](size_t index) {
+			return data()[index];
+		}
+		const T& operator[](size_t index) const {
+			return data()[index];
+		}
+
+		T& front() {
+			if (m_size == 0) throw std::out_of_range("Array is empty!");
+			return data()[0];
+		}
+		const T& front() const {
+			if (m_size == 0) throw std::out_of_range("Array is empty!");
+			return data()[0];
+		}
+
+		T& back() {
+			if (m_size == 0) throw std::out_of_range("Array is empty!");
+			return data()[m_size - 1];
+		}
+		const T& back() const {
+			if (m_size == 0) throw std::out_of_range("Array is empty!");
+			return data()[m_size - 1];
+		}
+
+		size_t size() const { return m_size; }
+		size_t capacity() const { return m_capacity; }
+		bool empty() const noexcept { return m_size == 0; }
+
+		T* data() noexcept { return m_base ? reinterpret_cast<T*>(m_base + HeaderSize) : nullptr; }
+		const T* data() const noexcept { return m_base ? reinterpret_cast<const T*>(m_base + HeaderSize) : nullptr; }
+
+
+		/********************** Iterators **********************/
+
+		T* begin() noexcept { return data(); }
+		T* end()   noexcept { return data() + m_size; }
+		const T* begin() const noexcept { return data(); }
+		const T* end()   const noexcept { return data() + m_size; }
+		const T* cbegin() const noexcept { return data(); }
+		const T* cend()   const noexcept { return data() + m_size; }
+
+
+		/********************** Setters **********************/
+
+		void reserve(size_t newCapacity) {
+			if (!m_base) throw std::logic_error("MappedVector: not open");
+			if (newCapacity <= m_capacity) return;
+
+			size_t bytes = HeaderSize + newCapacity * sizeof(T);
+			bytes = (bytes + GrowthGranularity - 1) / GrowthGranularity * GrowthGranularity;
+
+			growFile(bytes);
+			m_capacity = (m_mappedBytes - HeaderSize) / sizeof(T);
+		}
+
+		void push_back(const T& val) {
+			emplace_back(val);
+		}
+
+		template <typename... Args>
+		T& emplace_back(Args&&... args) {
+			if (m_size == m_capacity) {
+				// args may refer into the mapping, which growth can move
+				T copy(std::forward<Args>(args)...);
+				reserve(GrowOneAndHalf::next(m_capacity, m_size + 1, sizeof(T)));
+				data()[m_size] = copy;
+			}
+			else {
+				::new (static_cast<void*>(data() + m_size)) T(std::forward<Args>(args)...);
+			}
+			setSize(m_size + 1);
+			return data()[m_size - 1];
+		}
+
+		void insert_at(size_t index, const T& val) {
+			if (index > m_size) throw std::out_of_range("insert_at: index out of range");
+
+			T copy = val;
+			if (m_size == m_capacity) reserve(GrowOneAndHalf::next(m_capacity, m_size + 1, sizeof(T)));
+
+			T* slot = data() + index;
+			std::memmove(static_cast<void*>(slot + 1), static_cast<const void*>(slot), (m_size - index) * sizeof(T));
+			*slot = copy;
+			setSize(m_size + 1);
+		}
+
+		void erase_at(size_t index) {
+			if (index >= m_size) throw std::out_of_range("erase_at: index out of range");
+
+			T* slot = data() + index;
+			std::memmove(static_cast<void*>(slot), static_cast<const void*>(slot + 1), (m_size - index - 1) * sizeof(T));
+			setSize(m_size - 1);
+		}
+
+		void pop_back() {
+			if (m_size == 0) throw std::out_of_range("pop_back on empty array");
+			setSize(m_size - 1);
+		}
+
+		// Drops all elements; the file keeps its capacity
+		void clear() noexcept {
+			if (m_base) setSize(0);
+		}
+
+
+		/********************** Utility **********************/
+
+		static constexpr size_t npos = static_cast<size_t>(-1);
+		size_t find(const T& val) const {
+			if constexpr (simd::is_vectorizable_v<T>) {
+				return simd::find(data(), m_size, val);
+			}
+			else {
+				for (size_t i = 0; i < m_size; ++i) if (data()[i] == val) return i;
+				return npos;
+			}
+		}
+
+		void swap(MappedVector& other) noexcept {
+			std::swap(m_base, other.m_base);
+			std::swap(m_size, other.m_size);
+			std::swap(m_capacity, other.m_capacity);
+			std::swap(m_mappedBytes, other.m_mappedBytes);
+			std::swap(m_file, other.m_file);
+		}
+
+	private:
+		struct Header {
+			char magic[8];
+			uint64_t elementSize;
+			uint64_t size;
+		};
+
+		static constexpr size_t HeaderSize = 64;
+		static constexpr size_t GrowthGranularity = 64 * 1024;   // multiple of page size and of the Windows allocation granularity
+		static constexpr char Magic[8] = { 'p', 'S', 'T', 'L', 'M', 'V', 'E', 'C' };
+		static_assert(sizeof(Header) <= HeaderSize, "MappedVector: header does not fit");
+		static_assert(alignof(T) <= HeaderSize, "MappedVector: over-aligned element type");
+
+		Header* header() noexcept { return reinterpret_cast<Header*>(m_base); }
+		const Header* header() const noexcept { return reinterpret_cast<const Header*>(m_base); }
+
+		void setSize(size_t size) noexcept {
+			m_size = size;
+			header()->size = size;
+		}
+
+
+		/********************** Platform **********************/
+
+#if defined(_WIN32)
+		using file_t = HANDLE;
+		static file_t invalidFile() noexcept { return INVALID_HANDLE_VALUE; }
+
+		static file_t openFile(const std::string& path, bool& created) {
+			HANDLE file = ::CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+				nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("MappedVector: cannot open " + path);
+			created = ::GetLastError() != ERROR_ALREADY_EXISTS;
+			return file;
+		}
+
+		void closeFile() noexcept {
+			::CloseHandle(m_file);
+			m_file = invalidFile();
+		}
+
+		uint64_t fileSize() const {
+			LARGE_INTEGER size;
+			if (!::GetFileSizeEx(m_file, &size)) throw std::runtime_error("MappedVector: cannot stat file");
+			return static_cast<uint64_t>(size.QuadPart);
+		}
+
+		void resizeFile(size_t bytes) {
+			LARGE_INTEGER pos;
+			pos.QuadPart = static_cast<LONGLONG>(bytes);
+			if (!::SetFilePointerEx(m_file, pos, nullptr, FILE_BEGIN) || !::SetEndOfFile(m_file)) {
+				throw std::runtime_error("MappedVector: cannot resize file");
+			}
+		}
+
+		void map(size_t bytes) {
+			HANDLE mapping = ::CreateFileMappingA(m_file, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+			if (!mapping) throw std::runtime_error("MappedVector: cannot map file");
+			void* view = ::MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes);
+			::CloseHandle(mapping); // the view keeps the mapping object alive
+			if (!view) throw std::runtime_error("MappedVector: cannot map file");
+
+			m_base = static_cast<char*>(view);
+			m_mappedBytes = bytes;
+		}
+
+		void unmap() noexcept {
+			::UnmapViewOfFile(m_base);
+			m_base = nullptr;
+			m_mappedBytes = 0;
+		}
+
+		// A file cannot be extended while views of it exist
+		void growFile(size_t bytes) {
+			size_t oldBytes = m_mappedBytes;
+			unmap();
+			try {
+				resizeFile(bytes);
+			}
+			catch (...) {
+				map(oldBytes);
+				throw;
+			}
+			map(bytes);
+		}
+#else
+		using file_t = int;
+		static file_t invalidFile() noexcept { return -1; }
+
+		static file_t openFile(const std::string& path, bool& created) {
+			int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+			created = fd >= 0;
+			if (fd < 0) fd = ::open(path.c_str(), O_RDWR);
+			if (fd < 0) throw std::runtime_error("MappedVector: cannot open " + path);
+			return fd;
+		}
+
+		void closeFile() noexcept {
+			::close(m_file);
+			m_file = invalidFile();
+		}
+
+		uint64_t fileSize() const {
+			struct stat st;
+			if (::fstat(m_file, &st) != 0) throw std::runtime_error("MappedVector: cannot stat file");
+			return static_cast<uint64_t>(st.st_size);
+		}
+
+		void resizeFile(size_t bytes) {
+			if (::ftruncate(m_file, static_cast<off_t>(bytes)) != 0) throw std::runtime_error("MappedVector: cannot resize file");
+		}
+
+		void map(size_t bytes) {
+			void* view = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, m_file, 0);
+			if (view == MAP_FAILED) throw std::runtime_error("MappedVector: cannot map file");
+
+			m_base = static_cast<char*>(view);
+			m_mappedBytes = bytes;
+		}
+
+		void unmap() noexcept {
+			::munmap(m_base, m_mappedBytes);
+			m_base = nullptr;
+			m_mappedBytes = 0;
+		}
+
+		// On failure the file is shrunk back and the old view stays mapped,
+		// like the Windows version
+		void growFile(size_t bytes) {
+			size_t oldBytes = m_mappedBytes;
+			resizeFile(bytes);
+#if defined(__linux__)
+			void* view = ::mremap(m_base, oldBytes, bytes, MREMAP_MAYMOVE);
+#else
+			// Map the grown file before dropping the old view
+			void* view = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, m_file, 0);
+#endif
+			if (view == MAP_FAILED) {
+				try { resizeFile(oldBytes); }
+				catch (...) {} // a longer file is harmless: the old view is what counts
+				throw std::runtime_error("MappedVector: cannot grow mapping");
+			}
+#if !defined(__linux__)
+			::munmap(m_base, oldBytes);
+#endif
+			m_base = static_cast<char*>(view);
+			m_mappedBytes = bytes;
+		}
+#endif
+
+		char* m_base;
+		size_t m_size;
+		size_t m_capacity;
+		size_t m_mappedBytes;
+		file_t m_file;
+	};
+}
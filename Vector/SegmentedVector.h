@@ -0,0 +1,283 @@
+#pragma once
+
+#include <stdexcept>
+#include <utility>
+#include <memory>
+#include <new>
+#include <iterator>
+#include <type_traits>
+
+#include "Vector.h"
+
+namespace pSTL {
+	// Vector-like container stored in fixed-size chunks of 2^ChunkShift
+	// elements. Growing only allocates a new chunk, so elements never move
+	// and pointers/references to them stay valid until the element itself
+	// is removed. Random access is one shift, one mask and two loads.
+	// Only the chunk table (one pointer per chunk) is ever reallocated
+	template <typename T, size_t ChunkShift = 10>
+	class SegmentedVector {
+		static_assert(ChunkShift > 0 && ChunkShift < 32, "SegmentedVector: unreasonable chunk size");
+
+	public:
+		static constexpr size_t chunk_size = static_cast<size_t>(1) << ChunkShift;
+		static constexpr size_t chunk_mask = chunk_size - 1;
+
+
+		/********************** Iterators **********************/
+
+		template <bool Const>
+		class Iterator {
+		public:
+			using iterator_category = std::random_access_iterator_tag;
+			using value_type = T;
+			using difference_type = std::ptrdiff_t;
+			using pointer = std::conditional_t<Const, const T*, T*>;
+			using reference = std::conditional_t<Const, const T&, T&>;
+
+			Iterator() noexcept : m_chunks(nullptr), m_index(0) {}
+			Iterator(T* const* chunks, size_t index) noexcept : m_chunks(chunks), m_index(index) {}
+
+			// iterator -> const_iterator
+			template <bool C = Const, typename = std::enable_if_t<C>>
+			Iterator(const Iterator<false>& other) noexcept : m_chunks(other.chunks()), m_index(other.index()) {}
+
+			reference operator*() const { return m_chunks[m_index >> ChunkShift][m_index & chunk_mask]; }
+			pointer operator->() const { return &**this; }
+			reference operator[](difference_type n) const { return *(*this + n); }
+
+			Iterator& operator++() { ++m_index; return *this; }
+			Iterator operator++(int) { Iterator temp = *this; ++m_index; return temp; }
+			Iterator& operator--() { --m_index; return *this; }
+			Iterator operator--(int) { Iterator temp = *this; --m_index; return temp; }
+
+			Iterator& operator+=(difference_type n) { m_index += n; return *this; }
+			Iterator& operator-=(difference_type n) { m_index -= n; return *this; }
+			Iterator operator+(difference_type n) const { return Iterator(m_chunks, m_index + n); }
+			Iterator operator-(difference_type n) const { return Iterator(m_chunks, m_index - n); }
+			friend Iterator operator+(difference_type n, const Iterator& it) { return it + n; }
+			difference_type operator-(const Iterator& other) const {
+				return static_cast<difference_type>(m_index) - static_cast<difference_type>(other.m_index);
+			}
+
+			bool operator==(const Iterator& other) const { return m_index == other.m_index; }
+			bool operator!=(const Iterator& other) const { return m_index != other.m_index; }
+			bool operator<(const Iterator& other) const { return m_index < other.m_index; }
+			bool operator>(const Iterator& other) const { return m_index > other.m_index; }
+			bool operator<=(const Iterator& other) const { return m_index <= other.m_index; }
+			bool operator>=(const Iterator& other) const { return m_index >= other.m_index; }
+
+			T* const* chunks() const noexcept { return m_chunks; }
+			size_t index() const noexcept { return m_index; }
+
+		private:
+			T* const* m_chunks;
+			size_t m_index;
+		};
+
+		using iterator = Iterator<false>;
+		using const_iterator = Iterator<true>;
+
+
+		/********************** Constructors **********************/
+
+		SegmentedVector() noexcept
+			: m_size(0) {
+		}
+
+		explicit SegmentedVector(size_t size)
+			: SegmentedVector() {
+			reserve(size);
+			for (size_t i = 0; i < size; i++) emplace_back();
+		}
+
+		SegmentedVector(size_t size, const T& initValue)
+			: SegmentedVector() {
+			if (size == 0) throw std::invalid_argument("SegmentedVector(size, initValue): size must be > 0");
+
+			reserve(size);
+			for (size_t i = 0; i < size; i++) emplace_back(initValue);
+		}
+
+		SegmentedVector(const SegmentedVector& other)
+			: SegmentedVector() {
+			reserve(other.m_size);
+			for (size_t i = 0; i < other.m_size; i++) emplace_back(other[i]);
+		}
+
+		SegmentedVector(SegmentedVector&& other) noexcept
+			: m_chunks(std::move(other.m_chunks)), m_size(other.m_size) {
+			other.m_size = 0;
+		}
+
+		SegmentedVector& operator=(const SegmentedVector& other) {
+			SegmentedVector temp = other;
+			swap(temp);
+
+			return *this;
+		}
+
+		SegmentedVector& operator=(SegmentedVector&& other) noexcept {
+			swap(other);
+
+			return *this;
+		}
+
+		~SegmentedVector() {
+			clear();
+			for (T* chunk : m_chunks) deallocateChunk(chunk);
+		}
+
+
+		/********************** Getters **********************/
+
+		T& at(size_t index) {
+			if (index >= m_size) throw std::out_of_range("Out of bound access!");
+			return (*this)[index];
+		}
+		const T& at(size_t index) const {
+			if (index >= m_size) throw std::out_of_range("Out of bound access!");
+			return (*this)[index];
+		}
+
+		T& operator[](size_t index) {
+			return m_chunks[index >> ChunkShift][index & chunk_mask];
+		}
+		const T& operator[](size_t index) const {
+			return m_chunks[index >> ChunkShift][index & chunk_mask];
+		}
+
+		T& front() {
+			if (m_size == 0) throw std::out_of_range("Array is empty!");
+			return (*this)[0];
+		}
+		const T& front() const {
+			if (m_size == 0) throw std::out_of_range("Array is empty!");
+			return (*this)[0];
+		}
+
+		T& back() {
+			if (m_size == 0) throw std::out_of_range("Array is empty!");
+			return (*this)[m_size - 1];
+		}
+		const T& back() const {
+			if (m_size == 0) throw std::out_of_range("Array is empty!");
+			return (*this)[m_size - 1];
+		}
+
+		size_t size() const { return m_size; }
+		size_t capacity() const { return m_chunks.size() << ChunkShift; }
+		bool empty() const noexcept { return m_size == 0; }
+		size_t chunk_count() const noexcept { return m_chunks.size(); }
+
+
+		/********************** Iterators **********************/
+
+		iterator begin() noexcept { return iterator(m_chunks.begin(), 0); }
+		iterator end()   noexcept { return iterator(m_chunks.begin(), m_size); }
+		const_iterator begin() const noexcept { return const_iterator(m_chunks.begin(), 0); }
+		const_iterator end()   const noexcept { return const_iterator(m_chunks.begin(), m_size); }
+		const_iterator cbegin() const noexcept { return begin(); }
+		const_iterator cend()   const noexcept { return end(); }
+
+
+		/********************** Setters **********************/
+
+		// Allocates chunks up front; existing elements are not touched
+		void reserve(size_t newCapacity) {
+			size_t needed = (newCapacity + chunk_mask) >> ChunkShift;
+			if (needed <= m_chunks.size()) return;
+
+			m_chunks.reserve(needed);
+			while (m_chunks.size() < needed) {
+				m_chunks.push_back(allocateChunk());
+			}
+		}
+
+		void push_back(const T& val) {
+			emplace_back(val);
+		}
+		void push_back(T&& val) {
+			emplace_back(std::move(val));
+		}
+
+		// A new chunk is added before construction, and existing elements
+		// never move, so args may alias elements of *this
+		template <typename... Args>
+		T& emplace_back(Args&&... args) {
+			if (m_size == capacity()) {
+				T* chunk = allocateChunk();
+				try {
+					m_chunks.push_back(chunk);
+				}
+				catch (...) {
+					deallocateChunk(chunk);
+					throw;
+				}
+			}
+
+			T* slot = &m_chunks[m_size >> ChunkShift][m_size & chunk_mask];
+			::new (static_cast<void*>(slot)) T(std::forward<Args>(args)...);
+			m_size++;
+			return *slot;
+		}
+
+		void pop_back() {
+			if (m_size == 0) throw std::out_of_range("pop_back on empty array");
+
+			if constexpr (std::is_pointer<T>::value) {
+				delete back();
+			}
+			m_size--;
+			std::destroy_at(&(*this)[m_size]);
+		}
+
+		// Destroys all elements but keeps the chunks for reuse
+		void clear() noexcept {
+			for (size_t chunk = 0; chunk * chunk_size < m_size; chunk++) {
+				size_t count = m_size - chunk * chunk_size;
+				std::destroy_n(m_chunks[chunk], count < chunk_size ? count : chunk_size);
+			}
+			m_size = 0;
+		}
+
+
+		/********************** Utility **********************/
+
+		static constexpr size_t npos = static_cast<size_t>(-1);
+		size_t find(const T& val) const {
+			for (size_t chunk = 0; chunk * chunk_size < m_size; chunk++) {
+				size_t count = m_size - chunk * chunk_size;
+				if (count > chunk_size) count = chunk_size;
+
+				size_t pos;
+				if constexpr (simd::is_vectorizable_v<T>) {
+					pos = simd::find(m_chunks[chunk], count, val);
+				}
+				else {
+					pos = npos;
+					for (size_t i = 0; i < count; ++i) if (m_chunks[chunk][i] == val) { pos = i; break; }
+				}
+				if (pos != npos) return (chunk << ChunkShift) + pos;
+			}
+			return npos;
+		}
+
+		void swap(SegmentedVector& other) noexcept {
+			m_chunks.swap(other.m_chunks);
+			std::swap(m_size, other.m_size);
+		}
+
+	private:
+		static T* allocateChunk() {
+			return static_cast<T*>(::operator new(chunk_size * sizeof(T), std::align_val_t(alignof(T))));
+		}
+
+		static void deallocateChunk(T* chunk) noexcept {
+			::operator delete(chunk, std::align_val_t(alignof(T)));
+		}
+
+		Vector<T*> m_chunks;
+		size_t m_size;
+	};
+}
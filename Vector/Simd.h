@@ -0,0 +1,457 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if !defined(PSTL_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define PSTL_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+/*
+* Vectorized search kernels over contiguous arrays of arithmetic values.
+*
+* Each entry point (find, find_if, count, contains, min_element,
+* max_element) picks at compile time between a SIMD kernel and a scalar
+* loop based on the element type, and at run time between AVX2 and SSE2
+* based on the CPU. Element types are mapped onto fixed-width lane types
+* (int8_t ... uint64_t, float, double); bool, long double and anything
+* non-arithmetic always take the scalar loop. Define PSTL_NO_SIMD to force
+* the scalar loops everywhere, or PSTL_NO_AVX2 to stay on SSE2.
+*
+* find_if is vectorized for the predicate objects below; any other
+* callable gets the scalar loop. min_element/max_element are vectorized
+* for integers only, so floating point keeps std::min_element's NaN
+* behaviour.
+*/
+
+namespace pSTL {
+	namespace simd {
+		static constexpr size_t npos = static_cast<size_t>(-1);
+
+
+		/********************** Predicates **********************/
+
+		enum class cmp_op { eq, ne, lt, gt };
+
+		template <typename T>
+		struct equal_to {
+			static constexpr cmp_op op = cmp_op::eq;
+			T value;
+			bool operator()(const T& x) const { return x == value; }
+		};
+
+		template <typename T>
+		struct not_equal_to {
+			static constexpr cmp_op op = cmp_op::ne;
+			T value;
+			bool operator()(const T& x) const { return x != value; }
+		};
+
+		template <typename T>
+		struct less_than {
+			static constexpr cmp_op op = cmp_op::lt;
+			T value;
+			bool operator()(const T& x) const { return x < value; }
+		};
+
+		template <typename T>
+		struct greater_than {
+			static constexpr cmp_op op = cmp_op::gt;
+			T value;
+			bool operator()(const T& x) const { return x > value; }
+		};
+
+
+		/********************** Type mapping **********************/
+
+		template <size_t Size, bool Signed> struct int_lane {};
+		template <> struct int_lane<1, true> { using type = int8_t; };
+		template <> struct int_lane<1, false> { using type = uint8_t; };
+		template <> struct int_lane<2, true> { using type = int16_t; };
+		template <> struct int_lane<2, false> { using type = uint16_t; };
+		template <> struct int_lane<4, true> { using type = int32_t; };
+		template <> struct int_lane<4, false> { using type = uint32_t; };
+		template <> struct int_lane<8, true> { using type = int64_t; };
+		template <> struct int_lane<8, false> { using type = uint64_t; };
+
+		template <typename T, typename = void>
+		struct lane { using type = void; };
+		template <typename T>
+		struct lane<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>> {
+			using type = typename int_lane<sizeof(T), std::is_signed_v<T>>::type;
+		};
+		template <>
+		struct lane<float> { using type = float; };
+		template <>
+		struct lane<double> { using type = double; };
+
+		// Lane type a T is processed as, or void when T has no SIMD kernels
+		template <typename T>
+		using lane_t = typename lane<std::remove_cv_t<T>>::type;
+
+		template <typename T>
+		inline constexpr bool is_vectorizable_v = !std::is_void_v<lane_t<T>>;
+
+		template <typename T, typename Pred>
+		inline constexpr bool is_simd_predicate_v =
+			std::is_same_v<Pred, equal_to<T>> || std::is_same_v<Pred, not_equal_to<T>> ||
+			std::is_same_v<Pred, less_than<T>> || std::is_same_v<Pred, greater_than<T>>;
+
+
+		/********************** Bit helpers **********************/
+
+		inline unsigned countTrailingZeros(uint32_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+			unsigned long index;
+			_BitScanForward(&index, mask);
+			return static_cast<unsigned>(index);
+#else
+			return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+		}
+
+		inline unsigned popCount(uint32_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+			mask = mask - ((mask >> 1) & 0x55555555u);
+			mask = (mask & 0x33333333u) + ((mask >> 2) & 0x33333333u);
+			return (((mask + (mask >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+#else
+			return static_cast<unsigned>(__builtin_popcount(mask));
+#endif
+		}
+
+		template <cmp_op Op, typename T>
+		inline bool compareScalar(const T& x, const T& value) {
+			if constexpr (Op == cmp_op::eq) return x == value;
+			else if constexpr (Op == cmp_op::ne) return x != value;
+			else if constexpr (Op == cmp_op::lt) return x < value;
+			else return x > value;
+		}
+
+
+		/********************** CPU detection **********************/
+
+#if defined(PSTL_SIMD_X86)
+		inline bool detectAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+			int regs[4];
+			__cpuid(regs, 0);
+			if (regs[0] < 7) return false;
+
+			__cpuid(regs, 1);
+			bool osxsave = (regs[2] & (1 << 27)) != 0;
+			bool avx = (regs[2] & (1 << 28)) != 0;
+			if (!osxsave || !avx) return false;
+			if ((_xgetbv(0) & 0x6) != 0x6) return false;
+
+			__cpuidex(regs, 7, 0);
+			return (regs[1] & (1 << 5)) != 0;
+#else
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2");
+#endif
+		}
+
+		inline bool has_avx2() {
+#if defined(PSTL_NO_AVX2)
+			return false;
+#else
+			static const bool supported = detectAvx2();
+			return supported;
+#endif
+		}
+#else
+		inline bool has_avx2() { return false; }
+#endif
+
+
+		/********************** SSE2 kernels **********************/
+
+#if defined(PSTL_SIMD_X86)
+		namespace sse2 {
+			template <typename L>
+			struct Lanes {
+				using reg = __m128i;
+				static constexpr size_t width = sizeof(reg) / sizeof(L);
+				static constexpr uint32_t full = 0xFFFFu;
+				static constexpr bool has_gt = sizeof(L) < 8;
+				static constexpr bool has_minmax = has_gt;
+
+				static reg load(const void* ptr) { return _mm_loadu_si128(static_cast<const reg*>(ptr)); }
+				static void store(L* ptr, reg r) { _mm_storeu_si128(reinterpret_cast<reg*>(ptr), r); }
+				static uint32_t mask(reg r) { return static_cast<uint32_t>(_mm_movemask_epi8(r)); }
+				static reg select(reg m, reg a, reg b) { return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b)); }
+
+				static reg set1(L v) {
+					if constexpr (sizeof(L) == 1) return _mm_set1_epi8(static_cast<char>(v));
+					else if constexpr (sizeof(L) == 2) return _mm_set1_epi16(static_cast<short>(v));
+					else if constexpr (sizeof(L) == 4) return _mm_set1_epi32(static_cast<int>(v));
+					else return _mm_set1_epi64x(static_cast<long long>(v));
+				}
+
+				static reg eq(reg a, reg b) {
+					if constexpr (sizeof(L) == 1) return _mm_cmpeq_epi8(a, b);
+					else if constexpr (sizeof(L) == 2) return _mm_cmpeq_epi16(a, b);
+					else if constexpr (sizeof(L) == 4) return _mm_cmpeq_epi32(a, b);
+					else {
+						// No 64-bit compare in SSE2: both 32-bit halves must match
+						reg e = _mm_cmpeq_epi32(a, b);
+						return _mm_and_si128(e, _mm_shuffle_epi32(e, _MM_SHUFFLE(2, 3, 0, 1)));
+					}
+				}
+
+				// a > b; unsigned lanes are biased into signed range first
+				static reg gt(reg a, reg b) {
+					if constexpr (!std::is_signed_v<L>) {
+						reg bias = set1(static_cast<L>(L(1) << (8 * sizeof(L) - 1)));
+						a = _mm_xor_si128(a, bias);
+						b = _mm_xor_si128(b, bias);
+					}
+					if constexpr (sizeof(L) == 1) return _mm_cmpgt_epi8(a, b);
+					else if constexpr (sizeof(L) == 2) return _mm_cmpgt_epi16(a, b);
+					else return _mm_cmpgt_epi32(a, b);
+				}
+			};
+
+			template <>
+			struct Lanes<float> {
+				using reg = __m128;
+				static constexpr size_t width = 4;
+				static constexpr uint32_t full = 0xFFFFu;
+				static constexpr bool has_gt = true;
+				static constexpr bool has_minmax = false;
+
+				static reg load(const void* ptr) { return _mm_loadu_ps(static_cast<const float*>(ptr)); }
+				static uint32_t mask(reg r) { return static_cast<uint32_t>(_mm_movemask_epi8(_mm_castps_si128(r))); }
+				static reg set1(float v) { return _mm_set1_ps(v); }
+				static reg eq(reg a, reg b) { return _mm_cmpeq_ps(a, b); }
+				static reg gt(reg a, reg b) { return _mm_cmpgt_ps(a, b); }
+			};
+
+			template <>
+			struct Lanes<double> {
+				using reg = __m128d;
+				static constexpr size_t width = 2;
+				static constexpr uint32_t full = 0xFFFFu;
+				static constexpr bool has_gt = true;
+				static constexpr bool has_minmax = false;
+
+				static reg load(const void* ptr) { return _mm_loadu_pd(static_cast<const double*>(ptr)); }
+				static uint32_t mask(reg r) { return static_cast<uint32_t>(_mm_movemask_epi8(_mm_castpd_si128(r))); }
+				static reg set1(double v) { return _mm_set1_pd(v); }
+				static reg eq(reg a, reg b) { return _mm_cmpeq_pd(a, b); }
+				static reg gt(reg a, reg b) { return _mm_cmpgt_pd(a, b); }
+			};
+
+#include "SimdKernels.inl"
+		}
+
+
+		/********************** AVX2 kernels **********************/
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+		namespace avx2 {
+			template <typename L>
+			struct Lanes {
+				using reg = __m256i;
+				static constexpr size_t width = sizeof(reg) / sizeof(L);
+				static constexpr uint32_t full = 0xFFFFFFFFu;
+				static constexpr bool has_gt = true;
+				static constexpr bool has_minmax = true;
+
+				static reg load(const void* ptr) { return _mm256_loadu_si256(static_cast<const reg*>(ptr)); }
+				static void store(L* ptr, reg r) { _mm256_storeu_si256(reinterpret_cast<reg*>(ptr), r); }
+				static uint32_t mask(reg r) { return static_cast<uint32_t>(_mm256_movemask_epi8(r)); }
+				static reg select(reg m, reg a, reg b) { return _mm256_blendv_epi8(b, a, m); }
+
+				static reg set1(L v) {
+					if constexpr (sizeof(L) == 1) return _mm256_set1_epi8(static_cast<char>(v));
+					else if constexpr (sizeof(L) == 2) return _mm256_set1_epi16(static_cast<short>(v));
+					else if constexpr (sizeof(L) == 4) return _mm256_set1_epi32(static_cast<int>(v));
+					else return _mm256_set1_epi64x(static_cast<long long>(v));
+				}
+
+				static reg eq(reg a, reg b) {
+					if constexpr (sizeof(L) == 1) return _mm256_cmpeq_epi8(a, b);
+					else if constexpr (sizeof(L) == 2) return _mm256_cmpeq_epi16(a, b);
+					else if constexpr (sizeof(L) == 4) return _mm256_cmpeq_epi32(a, b);
+					else return _mm256_cmpeq_epi64(a, b);
+				}
+
+				static reg gt(reg a, reg b) {
+					if constexpr (!std::is_signed_v<L>) {
+						reg bias = set1(static_cast<L>(L(1) << (8 * sizeof(L) - 1)));
+						a = _mm256_xor_si256(a, bias);
+						b = _mm256_xor_si256(b, bias);
+					}
+					if constexpr (sizeof(L) == 1) return _mm256_cmpgt_epi8(a, b);
+					else if constexpr (sizeof(L) == 2) return _mm256_cmpgt_epi16(a, b);
+					else if constexpr (sizeof(L) == 4) return _mm256_cmpgt_epi32(a, b);
+					else return _mm256_cmpgt_epi64(a, b);
+				}
+			};
+
+			template <>
+			struct Lanes<float> {
+				using reg = __m256;
+				static constexpr size_t width = 8;
+				static constexpr uint32_t full = 0xFFFFFFFFu;
+				static constexpr bool has_gt = true;
+				static constexpr bool has_minmax = false;
+
+				static reg load(const void* ptr) { return _mm256_loadu_ps(static_cast<const float*>(ptr)); }
+				static uint32_t mask(reg r) { return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_castps_si256(r))); }
+				static reg set1(float v) { return _mm256_set1_ps(v); }
+				static reg eq(reg a, reg b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+				static reg gt(reg a, reg b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+			};
+
+			template <>
+			struct Lanes<double> {
+				using reg = __m256d;
+				static constexpr size_t width = 4;
+				static constexpr uint32_t full = 0xFFFFFFFFu;
+				static constexpr bool has_gt = true;
+				static constexpr bool has_minmax = false;
+
+				static reg load(const void* ptr) { return _mm256_loadu_pd(static_cast<const double*>(ptr)); }
+				static uint32_t mask(reg r) { return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_castpd_si256(r))); }
+				static reg set1(double v) { return _mm256_set1_pd(v); }
+				static reg eq(reg a, reg b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+				static reg gt(reg a, reg b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+			};
+
+#include "SimdKernels.inl"
+		}
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+#endif
+
+
+		/********************** Scalar kernels **********************/
+
+		namespace scalar {
+			template <typename T, typename Pred>
+			size_t find_if(const T* data, size_t count, Pred pred) {
+				for (size_t i = 0; i < count; ++i) if (pred(data[i])) return i;
+				return npos;
+			}
+
+			template <typename T, typename Pred>
+			size_t count_if(const T* data, size_t count, Pred pred) {
+				size_t total = 0;
+				for (size_t i = 0; i < count; ++i) if (pred(data[i])) total++;
+				return total;
+			}
+
+			template <typename T, bool Max>
+			size_t extreme(const T* data, size_t count) {
+				if (count == 0) return npos;
+
+				size_t best = 0;
+				for (size_t i = 1; i < count; ++i) {
+					if (Max ? data[best] < data[i] : data[i] < data[best]) best = i;
+				}
+				return best;
+			}
+		}
+
+
+		/********************** Entry points **********************/
+
+		// Index of the first element matching pred, or npos
+		template <typename T, typename Pred>
+		size_t find_if(const T* data, size_t count, Pred pred) {
+#if defined(PSTL_SIMD_X86)
+			if constexpr (is_vectorizable_v<T> && is_simd_predicate_v<T, Pred>) {
+				using L = lane_t<T>;
+				if (has_avx2()) {
+					return avx2::findFirst<Pred::op, L>(data, count, pred.value);
+				}
+				if constexpr (Pred::op == cmp_op::eq || Pred::op == cmp_op::ne || sse2::Lanes<L>::has_gt) {
+					return sse2::findFirst<Pred::op, L>(data, count, pred.value);
+				}
+			}
+#endif
+			return scalar::find_if(data, count, pred);
+		}
+
+		template <typename T, typename Pred>
+		size_t count_if(const T* data, size_t count, Pred pred) {
+#if defined(PSTL_SIMD_X86)
+			if constexpr (is_vectorizable_v<T> && is_simd_predicate_v<T, Pred>) {
+				using L = lane_t<T>;
+				if (has_avx2()) {
+					return avx2::countMatches<Pred::op, L>(data, count, pred.value);
+				}
+				if constexpr (Pred::op == cmp_op::eq || Pred::op == cmp_op::ne || sse2::Lanes<L>::has_gt) {
+					return sse2::countMatches<Pred::op, L>(data, count, pred.value);
+				}
+			}
+#endif
+			return scalar::count_if(data, count, pred);
+		}
+
+		template <typename T>
+		size_t find(const T* data, size_t count, const T& value) {
+			return find_if(data, count, equal_to<T>{ value });
+		}
+
+		template <typename T>
+		size_t count(const T* data, size_t count, const T& value) {
+			return count_if(data, count, equal_to<T>{ value });
+		}
+
+		template <typename T>
+		bool contains(const T* data, size_t count, const T& value) {
+			return find(data, count, value) != npos;
+		}
+
+		// Index of the first smallest element, or npos when empty
+		template <typename T>
+		size_t min_element(const T* data, size_t count) {
+#if defined(PSTL_SIMD_X86)
+			if constexpr (is_vectorizable_v<T> && std::is_integral_v<T>) {
+				using L = lane_t<T>;
+				if (count != 0 && has_avx2()) {
+					return find(data, count, static_cast<T>(avx2::reduce<false, L>(data, count)));
+				}
+				if constexpr (sse2::Lanes<L>::has_minmax) {
+					if (count != 0) return find(data, count, static_cast<T>(sse2::reduce<false, L>(data, count)));
+				}
+			}
+#endif
+			return scalar::extreme<T, false>(data, count);
+		}
+
+		// Index of the first largest element, or npos when empty
+		template <typename T>
+		size_t max_element(const T* data, size_t count) {
+#if defined(PSTL_SIMD_X86)
+			if constexpr (is_vectorizable_v<T> && std::is_integral_v<T>) {
+				using L = lane_t<T>;
+				if (count != 0 && has_avx2()) {
+					return find(data, count, static_cast<T>(avx2::reduce<true, L>(data, count)));
+				}
+				if constexpr (sse2::Lanes<L>::has_minmax) {
+					if (count != 0) return find(data, count, static_cast<T>(sse2::reduce<true, L>(data, count)));
+				}
+			}
+#endif
+			return scalar::extreme<T, true>(data, count);
+		}
+	}
+}
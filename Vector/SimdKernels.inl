@@ -0,0 +1,83 @@
+// ISA-independent kernel bodies, included by Simd.h once per instruction set
+// inside a namespace that defines Lanes<L> for that set. Full vectors are
+// loaded as lane type L; leftovers are handled by a scalar loop over T
+
+// One bit per byte of the register, set where the lane matches
+template <cmp_op Op, typename L, typename Reg>
+inline uint32_t matchMask(Reg x, Reg needle) {
+	using V = Lanes<L>;
+	if constexpr (Op == cmp_op::eq) return V::mask(V::eq(x, needle));
+	else if constexpr (Op == cmp_op::ne) return ~V::mask(V::eq(x, needle)) & V::full;
+	else if constexpr (Op == cmp_op::lt) return V::mask(V::gt(needle, x));
+	else return V::mask(V::gt(x, needle));
+}
+
+template <cmp_op Op, typename L, typename T>
+size_t findFirst(const T* data, size_t count, const T& value) {
+	using V = Lanes<L>;
+	const auto needle = V::set1(static_cast<L>(value));
+
+	size_t i = 0;
+	for (; i + 2 * V::width <= count; i += 2 * V::width) {
+		uint32_t lo = matchMask<Op, L>(V::load(data + i), needle);
+		uint32_t hi = matchMask<Op, L>(V::load(data + i + V::width), needle);
+		if (lo | hi) {
+			if (lo) return i + countTrailingZeros(lo) / sizeof(L);
+			return i + V::width + countTrailingZeros(hi) / sizeof(L);
+		}
+	}
+	for (; i + V::width <= count; i += V::width) {
+		uint32_t m = matchMask<Op, L>(V::load(data + i), needle);
+		if (m) return i + countTrailingZeros(m) / sizeof(L);
+	}
+	for (; i < count; ++i) {
+		if (compareScalar<Op>(data[i], value)) return i;
+	}
+	return npos;
+}
+
+template <cmp_op Op, typename L, typename T>
+size_t countMatches(const T* data, size_t count, const T& value) {
+	using V = Lanes<L>;
+	const auto needle = V::set1(static_cast<L>(value));
+
+	size_t bits = 0;
+	size_t i = 0;
+	for (; i + V::width <= count; i += V::width) {
+		bits += popCount(matchMask<Op, L>(V::load(data + i), needle));
+	}
+
+	size_t total = bits / sizeof(L);
+	for (; i < count; ++i) {
+		if (compareScalar<Op>(data[i], value)) total++;
+	}
+	return total;
+}
+
+// Smallest (Max = false) or largest value of a non-empty integer array
+template <bool Max, typename L, typename T>
+L reduce(const T* data, size_t count) {
+	using V = Lanes<L>;
+
+	L best = static_cast<L>(data[0]);
+	size_t i = 0;
+	if (count >= V::width) {
+		auto acc = V::load(data);
+		for (i = V::width; i + V::width <= count; i += V::width) {
+			auto x = V::load(data + i);
+			acc = Max ? V::select(V::gt(x, acc), x, acc) : V::select(V::gt(acc, x), x, acc);
+		}
+
+		L lanes[V::width];
+		V::store(lanes, acc);
+		best = lanes[0];
+		for (size_t j = 1; j < V::width; ++j) {
+			if (Max ? best < lanes[j] : lanes[j] < best) best = lanes[j];
+		}
+	}
+	for (; i < count; ++i) {
+		L x = static_cast<L>(data[i]);
+		if (Max ? best < x : x < best) best = x;
+	}
+	return best;
+}
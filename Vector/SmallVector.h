@@ -0,0 +1,343 @@
+#pragma once
+
+#include <stdexcept>
+#include <utility>
+#include <memory>
+#include <new>
+#include <cstring>
+#include <type_traits>
+
+#include "Vector.h"
+
+namespace pSTL {
+	// Vector with room for N elements inside the object itself. Nothing is
+	// heap allocated until the (N + 1)th element arrives; from then on it
+	// behaves like Vector. Moving an inline SmallVector relocates its elements
+	// instead of stealing a pointer, so it is O(size) rather than O(1)
+	template <typename T, size_t N = 8>
+	class SmallVector {
+		static_assert(N > 0, "SmallVector: inline capacity must be > 0");
+
+	public:
+		/********************** Constructors **********************/
+
+		SmallVector() noexcept
+			: m_size(0), m_capacity(N), m_arr(inlineData()) {
+		}
+
+		explicit SmallVector(size_t size)
+			: SmallVector() {
+			reserve(size);
+			std::uninitialized_value_construct_n(m_arr, size);
+			m_size = size;
+		}
+
+		SmallVector(size_t size, const T& initValue)
+			: SmallVector() {
+			if (size == 0) throw std::invalid_argument("SmallVector(size, initValue): size must be > 0");
+
+			reserve(size);
+			std::uninitialized_fill_n(m_arr, size, initValue);
+			m_size = size;
+		}
+
+		SmallVector(const SmallVector& other)
+			: SmallVector() {
+			reserve(other.m_size);
+			std::uninitialized_copy_n(other.m_arr, other.m_size, m_arr);
+			m_size = other.m_size;
+		}
+
+		SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+			: SmallVector() {
+			takeFrom(other);
+		}
+
+		SmallVector& operator=(const SmallVector& other) {
+			if (this == &other)
+				return *this;
+
+			clear();
+			reserve(other.m_size);
+			std::uninitialized_copy_n(other.m_arr, other.m_size, m_arr);
+			m_size = other.m_size;
+
+			return *this;
+		}
+
+		SmallVector& operator=(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+			if (this == &other)
+				return *this;
+
+			clear();
+			releaseHeap();
+			takeFrom(other);
+
+			return *this;
+		}
+
+		~SmallVector() {
+			clear();
+			releaseHeap();
+		}
+
+
+		/********************** Getters **********************/
+
+		T& at(size_t index) {
+			if (index >= m_size) throw std::out_of_range("Out of bound access!");
+			return m_arr[index];
+		}
+		const T& at(size_t index) const {
+			if (index >= m_size) throw std::out_of_range("Out of bound access!");
+			return m_arr[index];
+		}
+
+		T& operator[](size_t index) {
+			return m_arr[index];
+		}
+		const T& operator[](size_t index) const {
+			return m_arr[index];
+		}
+
+		T& front() {
+			if (m_size == 0) throw std::out_of_range("Array is empty!");
+			return m_arr[0];
+		}
+		const T& front() const {
+			if (m_size == 0) throw std::out_of_range("Array is empty!");
+			return m_arr[0];
+		}
+
+		T& back() {
+			if (m_size == 0) throw std::out_of_range("Array is empty!");
+			return m_arr[m_size - 1];
+		}
+		const T& back() const {
+			if (m_size == 0) throw std::out_of_range("Array is empty!");
+			return m_arr[m_size - 1];
+		}
+
+		size_t size() const { return m_size; }
+		size_t capacity() const { return m_capacity; }
+		bool empty() const noexcept { return m_size == 0; }
+		bool is_inline() const noexcept { return m_arr == inlineData(); }
+
+		static constexpr size_t inline_capacity() noexcept { return N; }
+
+
+		/********************** Iterators **********************/
+
+		T* begin() noexcept { return m_arr; }
+		T* end()   noexcept { return m_arr + m_size; }
+		const T* begin() const noexcept { return m_arr; }
+		const T* end()   const noexcept { return m_arr + m_size; }
+		const T* cbegin() const noexcept { return m_arr; }
+		const T* cend()   const noexcept { return m_arr + m_size; }
+
+
+		/********************** Setters **********************/
+
+		void reserve(size_t newCapacity) {
+			if (newCapacity <= m_capacity) return;
+
+			T* tempArr = allocate(newCapacity);
+			try {
+				relocate_n(m_arr, m_size, tempArr);
+			}
+			catch (...) {
+				deallocate(tempArr);
+				throw;
+			}
+
+			releaseHeap();
+			m_arr = tempArr;
+			m_capacity = newCapacity;
+		}
+
+		void push_back(const T& val) {
+			emplace_back(val);
+		}
+		void push_back(T&& val) {
+			emplace_back(std::move(val));
+		}
+
+		// Same aliasing guarantee as Vector::emplace_back: on spill the new
+		// element is constructed before the old ones leave their slots
+		template <typename... Args>
+		T& emplace_back(Args&&... args) {
+			if (m_size == m_capacity) {
+				size_t newCapacity = nextCapacity();
+				T* tempArr = allocate(newCapacity);
+				try {
+					::new (static_cast<void*>(tempArr + m_size)) T(std::forward<Args>(args)...);
+				}
+				catch (...) {
+					deallocate(tempArr);
+					throw;
+				}
+				try {
+					relocate_n(m_arr, m_size, tempArr);
+				}
+				catch (...) {
+					std::destroy_at(tempArr + m_size);
+					deallocate(tempArr);
+					throw;
+				}
+
+				releaseHeap();
+				m_arr = tempArr;
+				m_capacity = newCapacity;
+			}
+			else {
+				::new (static_cast<void*>(m_arr + m_size)) T(std::forward<Args>(args)...);
+			}
+			return m_arr[m_size++];
+		}
+
+		void insert_at(size_t index, const T& val) {
+			if (index > m_size) throw std::out_of_range("insert_at: index out of range");
+
+			if (index == m_size) {
+				emplace_back(val);
+				return;
+			}
+
+			T copy(val);
+			if (m_size == m_capacity) {
+				reserve(nextCapacity());
+			}
+
+			if constexpr (is_trivially_relocatable_v<T>) {
+				T* slot = m_arr + index;
+				std::memmove(static_cast<void*>(slot + 1), static_cast<const void*>(slot), (m_size - index) * sizeof(T));
+				try {
+					::new (static_cast<void*>(slot)) T(std::move(copy));
+				}
+				catch (...) {
+					std::memmove(static_cast<void*>(slot), static_cast<const void*>(slot + 1), (m_size - index) * sizeof(T));
+					throw;
+				}
+				m_size++;
+			}
+			else {
+				::new (static_cast<void*>(m_arr + m_size)) T(std::move(m_arr[m_size - 1]));
+				m_size++;
+				for (size_t i = m_size - 2; i > index; i--) {
+					m_arr[i] = std::move(m_arr[i - 1]);
+				}
+
+				m_arr[index] = std::move(copy);
+			}
+		}
+
+		void erase_at(size_t index) {
+			if (index >= m_size) throw std::out_of_range("erase_at: index out of range");
+
+			if constexpr (std::is_pointer<T>::value) {
+				delete m_arr[index];
+			}
+
+			if constexpr (is_trivially_relocatable_v<T>) {
+				T* slot = m_arr + index;
+				std::destroy_at(slot);
+				std::memmove(static_cast<void*>(slot), static_cast<const void*>(slot + 1), (m_size - index - 1) * sizeof(T));
+			}
+			else {
+				for (size_t i = index + 1; i < m_size; i++) {
+					m_arr[i - 1] = std::move(m_arr[i]);
+				}
+				std::destroy_at(m_arr + m_size - 1);
+			}
+			m_size--;
+		}
+
+		void pop_back() {
+			if (m_size == 0) throw std::out_of_range("pop_back on empty array");
+
+			if constexpr (std::is_pointer<T>::value) {
+				delete m_arr[m_size - 1];
+			}
+			m_size--;
+			std::destroy_at(m_arr + m_size);
+		}
+
+		void clear() noexcept {
+			std::destroy_n(m_arr, m_size);
+			m_size = 0;
+		}
+
+
+		/********************** Utility **********************/
+
+		static constexpr size_t npos = static_cast<size_t>(-1);
+		size_t find(const T& val) const {
+			for (size_t i = 0; i < m_size; ++i) if (m_arr[i] == val) return i;
+			return npos;
+		}
+
+		// Two heap buffers swap pointers; otherwise inline elements have to move
+		void swap(SmallVector& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+			if (this == &other)
+				return;
+
+			if (!is_inline() && !other.is_inline()) {
+				std::swap(m_size, other.m_size);
+				std::swap(m_capacity, other.m_capacity);
+				std::swap(m_arr, other.m_arr);
+				return;
+			}
+
+			SmallVector temp(std::move(other));
+			other = std::move(*this);
+			*this = std::move(temp);
+		}
+
+	private:
+		/********************** Storage **********************/
+
+		T* inlineData() noexcept { return reinterpret_cast<T*>(m_inline); }
+		const T* inlineData() const noexcept { return reinterpret_cast<const T*>(m_inline); }
+
+		static T* allocate(size_t count) {
+			return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(alignof(T))));
+		}
+
+		static void deallocate(T* ptr) noexcept {
+			::operator delete(ptr, std::align_val_t(alignof(T)));
+		}
+
+		// Frees a heap buffer (whose elements are already gone) and falls back to inline storage
+		void releaseHeap() noexcept {
+			if (!is_inline()) {
+				deallocate(m_arr);
+				m_arr = inlineData();
+				m_capacity = N;
+			}
+		}
+
+		// Expects *this to be empty and inline
+		void takeFrom(SmallVector& other) {
+			if (other.is_inline()) {
+				relocate_n(other.m_arr, other.m_size, m_arr);
+			}
+			else {
+				m_arr = other.m_arr;
+				m_capacity = other.m_capacity;
+				other.m_arr = other.inlineData();
+				other.m_capacity = N;
+			}
+			m_size = other.m_size;
+			other.m_size = 0;
+		}
+
+		size_t nextCapacity() const {
+			return m_capacity * 3 / 2 + 1;
+		}
+
+		size_t m_size;
+		size_t m_capacity;
+		T* m_arr;
+		alignas(T) unsigned char m_inline[N * sizeof(T)];
+	};
+}
@@ -1,51 +1,136 @@
 #pragma once
 
-#include <stdexcept> 
+#include <stdexcept>
 #include <utility>
+#include <memory>
+#include <new>
+#include <cstring>
+#include <type_traits>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+
+#include "Simd.h"
+#include "GrowthPolicy.h"
 
 namespace pSTL {
+	/*
+	* A type is trivially relocatable if moving it to a new address and
+	* forgetting the old bytes is equivalent to move-construct + destroy.
+	* Every trivially copyable type qualifies; owning handles such as
+	* std::unique_ptr usually do too and may opt in by specializing:
+	*
+	*     template <> struct pSTL::is_trivially_relocatable<MyHandle> : std::true_type {};
+	*
+	* Vector then shifts and grows such elements with memcpy/memmove
+	*/
+	template <typename T>
+	struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+	template <typename T>
+	inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+	// Moves count live objects from src into uninitialized dst and ends
+	// their lifetime in src. Falls back to copying when T's move may throw
+	// so that a failed growth leaves the original buffer untouched
 	template <typename T>
+	void relocate_n(T* src, size_t count, T* dst) {
+		if (count == 0) return;
+
+		if constexpr (is_trivially_relocatable_v<T>) {
+			std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), count * sizeof(T));
+		}
+		else {
+			if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+				std::uninitialized_move_n(src, count, dst);
+			}
+			else {
+				std::uninitialized_copy_n(src, count, dst);
+			}
+			std::destroy_n(src, count);
+		}
+	}
+
+	// Alloc is any standard-conforming allocator. If it also provides
+	// bool expand(T* ptr, size_t oldCount, size_t newCount), growth first
+	// tries to extend the current block in place (see Allocator.h).
+	// Growth decides every capacity increase and may observe reallocations
+	// (see GrowthPolicy.h)
+	template <typename T, typename Alloc = std::allocator<T>, typename Growth = GrowOneAndHalf>
 	class Vector {
 	public:
+		using allocator_type = Alloc;
+		using growth_policy = Growth;
+
+
 		/********************** Constructors **********************/
 
-		Vector() noexcept
-			: m_size(0), m_capacity(0), m_arr(nullptr) {
+		Vector() noexcept(noexcept(Alloc()))
+			: m_size(0), m_capacity(0), m_arr(nullptr), m_alloc() {
 		}
 
-		explicit Vector(size_t size)
-			: m_size(size), m_capacity(size ? size * 3 / 2 : 0), m_arr(m_capacity ? new T[m_capacity]{} : nullptr) {
+		explicit Vector(const Alloc& alloc) noexcept
+			: m_size(0), m_capacity(0), m_arr(nullptr), m_alloc(alloc) {
 		}
 
-		Vector(size_t size, T initValue)
-			: m_size(size), m_capacity(size * 3 / 2), m_arr(m_capacity ? new T[m_capacity] : nullptr) {
+		explicit Vector(size_t size, const Alloc& alloc = Alloc())
+			: m_size(0), m_capacity(size ? size * 3 / 2 : 0), m_arr(nullptr), m_alloc(alloc) {
+			m_arr = allocate(m_capacity);
+			try {
+				std::uninitialized_value_construct_n(m_arr, size);
+			}
+			catch (...) {
+				deallocate(m_arr, m_capacity);
+				throw;
+			}
+			m_size = size;
+		}
 
-			// one compile time check and then runtime for unknown variables
-			static_assert(size > 0, "Vector(size, initValue): size must be > 0");
+		Vector(size_t size, const T& initValue, const Alloc& alloc = Alloc())
+			: m_size(0), m_capacity(size * 3 / 2), m_arr(nullptr), m_alloc(alloc) {
 			if (size == 0) throw std::invalid_argument("Vector(size, initValue): size must be > 0");
-			
-			for (int i = 0; i < size; i++) {
-				m_arr[i] = initValue;
+
+			m_arr = allocate(m_capacity);
+			try {
+				std::uninitialized_fill_n(m_arr, size, initValue);
+			}
+			catch (...) {
+				deallocate(m_arr, m_capacity);
+				throw;
 			}
+			m_size = size;
 		}
 
-		Vector(const Vector& other) noexcept
-			: m_size(other.m_size),
+		template <typename It, typename = typename std::iterator_traits<It>::iterator_category>
+		Vector(It first, It last, const Alloc& alloc = Alloc())
+			: Vector(alloc) {
+			append(first, last);
+		}
+
+		Vector(const Vector& other)
+			: m_size(0),
 			m_capacity(other.m_capacity),
-			m_arr(other.m_capacity ? new T[other.m_capacity] : nullptr) {
-			for (int i = 0; i < m_size; i++) {
-				m_arr[i] = other.m_arr[i];
+			m_arr(nullptr),
+			m_alloc(std::allocator_traits<Alloc>::select_on_container_copy_construction(other.m_alloc)) {
+			m_arr = allocate(m_capacity);
+			try {
+				std::uninitialized_copy_n(other.m_arr, other.m_size, m_arr);
 			}
+			catch (...) {
+				deallocate(m_arr, m_capacity);
+				throw;
+			}
+			m_size = other.m_size;
 		}
 
 		Vector(Vector&& other) noexcept
-			: m_size(other.m_size), m_capacity(other.m_capacity), m_arr(other.m_arr) {
+			: m_size(other.m_size), m_capacity(other.m_capacity), m_arr(other.m_arr), m_alloc(std::move(other.m_alloc)) {
 			other.m_size = 0;
 			other.m_capacity = 0;
 			other.m_arr = nullptr;
 		}
 
-		Vector& operator=(const Vector& other) noexcept {
+		Vector& operator=(const Vector& other) {
 			Vector temp = other;
 			std::swap(*this, temp);
 
@@ -56,12 +141,14 @@ namespace pSTL {
 			std::swap(m_size, other.m_size);
 			std::swap(m_capacity, other.m_capacity);
 			std::swap(m_arr, other.m_arr);
+			std::swap(m_alloc, other.m_alloc);
 
 			return *this;
 		}
 
 		~Vector() {
-			delete[] m_arr;
+			clear();
+			deallocate(m_arr, m_capacity);
 		}
 
 
@@ -104,6 +191,7 @@ namespace pSTL {
 		size_t size() const { return m_size; }
 		size_t capacity() const { return m_capacity; }
 		bool empty() const noexcept { return m_size == 0; }
+		allocator_type get_allocator() const noexcept { return m_alloc; }
 
 
 		/********************** Getters **********************/
@@ -120,54 +208,115 @@ namespace pSTL {
 
 		void reserve(size_t newCapacity) {
 			if (newCapacity <= m_capacity) return;
+			if (tryExpand(newCapacity)) return;
 
-			T* tempArr = new T[newCapacity];
-			for (size_t i = 0; i < m_size; i++) {
-				tempArr[i] = std::move(m_arr[i]);
+			T* tempArr = allocate(newCapacity);
+			try {
+				relocate_n(m_arr, m_size, tempArr);
+			}
+			catch (...) {
+				deallocate(tempArr, newCapacity);
+				throw;
 			}
 
-			m_capacity = newCapacity;
-			std::swap(m_arr, tempArr);
-			delete[] tempArr;
+			replaceBuffer(tempArr, newCapacity);
 		}
 
 		void push_back(const T& val) {
-			if (m_size == m_capacity) {
-				size_t newCapacity = m_capacity * 3 / 2;
-				if (newCapacity == 0) {
-					newCapacity = 1;
-				}
-
-				reserve(newCapacity);
-			}
-			m_arr[m_size++] = val;
+			emplace_back(val);
 		}
 		void push_back(T&& val) {
-			if (m_size == m_capacity) {
-				size_t newCapacity = m_capacity * 3 / 2 + 1;
-				if (newCapacity == 0) {
-					newCapacity = 1;
+			emplace_back(std::move(val));
+		}
+
+		// Constructs the new element directly in the first free slot.
+		// On growth the element is built in the new buffer before the old
+		// ones are relocated, so args may safely alias elements of *this
+		template <typename... Args>
+		T& emplace_back(Args&&... args) {
+			if (m_size == m_capacity && !tryExpand(nextCapacity())) {
+				size_t newCapacity = nextCapacity();
+				T* tempArr = allocate(newCapacity);
+				try {
+					::new (static_cast<void*>(tempArr + m_size)) T(std::forward<Args>(args)...);
+				}
+				catch (...) {
+					deallocate(tempArr, newCapacity);
+					throw;
+				}
+				try {
+					relocate_n(m_arr, m_size, tempArr);
+				}
+				catch (...) {
+					std::destroy_at(tempArr + m_size);
+					deallocate(tempArr, newCapacity);
+					throw;
 				}
 
-				reserve(newCapacity);
+				replaceBuffer(tempArr, newCapacity);
+			}
+			else {
+				::new (static_cast<void*>(m_arr + m_size)) T(std::forward<Args>(args)...);
 			}
-			m_arr[m_size++] = std::move(val);
+			return m_arr[m_size++];
 		}
 
 		void insert_at(size_t index, const T& val) {
 			if (index > m_size) throw std::out_of_range("insert_at: index out of range");
 
+			if (index == m_size) {
+				emplace_back(val);
+				return;
+			}
+
+			// val may live inside the buffer we are about to shift
+			T copy(val);
 			if (m_size == m_capacity) {
-				size_t newCap = m_capacity ? (m_capacity + m_capacity / 2) : 1;
-				reserve(newCap);
+				reserve(nextCapacity());
+			}
+
+			if constexpr (is_trivially_relocatable_v<T>) {
+				T* slot = m_arr + index;
+				std::memmove(static_cast<void*>(slot + 1), static_cast<const void*>(slot), (m_size - index) * sizeof(T));
+				try {
+					::new (static_cast<void*>(slot)) T(std::move(copy));
+				}
+				catch (...) {
+					std::memmove(static_cast<void*>(slot), static_cast<const void*>(slot + 1), (m_size - index) * sizeof(T));
+					throw;
+				}
+				m_size++;
+			}
+			else {
+				::new (static_cast<void*>(m_arr + m_size)) T(std::move(m_arr[m_size - 1]));
+				m_size++;
+				for (size_t i = m_size - 2; i > index; i--) {
+					m_arr[i] = std::move(m_arr[i - 1]);
+				}
+
+				m_arr[index] = std::move(copy);
 			}
+		}
 
-			for (size_t i = m_size; i > index; i--) {
-				m_arr[i] = std::move(m_arr[i - 1]);
+		void erase_at(size_t index) {
+			if (index >= m_size) throw std::out_of_range("erase_at: index out of range");
+
+			if constexpr (std::is_pointer<T>::value) {
+				delete m_arr[index];
 			}
 
-			m_arr[index] = val;                  
-			m_size++;
+			if constexpr (is_trivially_relocatable_v<T>) {
+				T* slot = m_arr + index;
+				std::destroy_at(slot);
+				std::memmove(static_cast<void*>(slot), static_cast<const void*>(slot + 1), (m_size - index - 1) * sizeof(T));
+			}
+			else {
+				for (size_t i = index + 1; i < m_size; i++) {
+					m_arr[i - 1] = std::move(m_arr[i]);
+				}
+				std::destroy_at(m_arr + m_size - 1);
+			}
+			m_size--;
 		}
 
 		void pop_back() {
@@ -175,29 +324,330 @@ namespace pSTL {
 
 			if constexpr (std::is_pointer<T>::value) {
 				delete m_arr[m_size - 1];
-				
-			} 
+
+			}
 			m_size--;
+			std::destroy_at(m_arr + m_size);
+		}
+
+		// Destroys all elements but keeps the allocated storage
+		void clear() noexcept {
+			std::destroy_n(m_arr, m_size);
+			m_size = 0;
+		}
+
+
+		/********************** Bulk modifiers **********************/
+
+		// All bulk operations size the result once, allocate at most once
+		// and shift the existing tail at most once
+
+		template <typename It>
+		void append(It first, It last) {
+			insert(m_size, first, last);
+		}
+
+		template <typename It>
+		void insert(size_t index, It first, It last) {
+			if (index > m_size) throw std::out_of_range("insert: index out of range");
+
+			using category = typename std::iterator_traits<It>::iterator_category;
+			if constexpr (!std::is_base_of_v<std::forward_iterator_tag, category>) {
+				// Single pass ranges cannot be measured up front
+				if (index == m_size) {
+					for (; first != last; ++first) emplace_back(*first);
+					return;
+				}
+				Vector temp(m_alloc);
+				temp.append(first, last);
+				insert(index, std::make_move_iterator(temp.begin()), std::make_move_iterator(temp.end()));
+				return;
+			}
+			else {
+				size_t count = static_cast<size_t>(std::distance(first, last));
+				if (count == 0) return;
+
+				size_t required = m_size + count;
+				if (required > m_capacity && !tryExpand(growthFor(required))) {
+					// The range is read before the old buffer is released, so it may alias *this
+					size_t newCapacity = growthFor(required);
+					T* tempArr = allocate(newCapacity);
+					try {
+						std::uninitialized_copy(first, last, tempArr + index);
+					}
+					catch (...) {
+						deallocate(tempArr, newCapacity);
+						throw;
+					}
+					try {
+						relocateAround(tempArr, index, count);
+					}
+					catch (...) {
+						std::destroy_n(tempArr + index, count);
+						deallocate(tempArr, newCapacity);
+						throw;
+					}
+
+					replaceBuffer(tempArr, newCapacity);
+					m_size = required;
+					return;
+				}
+
+				if constexpr (std::is_pointer_v<It> && std::is_same_v<std::remove_cv_t<std::remove_pointer_t<It>>, T>) {
+					if (isInside(first)) {
+						Vector temp(first, last, m_alloc);
+						insert(index, std::make_move_iterator(temp.begin()), std::make_move_iterator(temp.end()));
+						return;
+					}
+				}
+
+				size_t tail = m_size - index;
+				T* pos = m_arr + index;
+				T* oldEnd = m_arr + m_size;
+				if constexpr (is_trivially_relocatable_v<T>) {
+					std::memmove(static_cast<void*>(pos + count), static_cast<const void*>(pos), tail * sizeof(T));
+					try {
+						std::uninitialized_copy(first, last, pos);
+					}
+					catch (...) {
+						std::memmove(static_cast<void*>(pos), static_cast<const void*>(pos + count), tail * sizeof(T));
+						throw;
+					}
+					m_size = required;
+				}
+				else if (count <= tail) {
+					std::uninitialized_move(oldEnd - count, oldEnd, oldEnd);
+					m_size = required;
+					std::move_backward(pos, oldEnd - count, oldEnd);
+					std::copy(first, last, pos);
+				}
+				else {
+					It mid = first;
+					std::advance(mid, tail);
+					std::uninitialized_copy(mid, last, oldEnd);
+					try {
+						std::uninitialized_move(pos, oldEnd, pos + count);
+					}
+					catch (...) {
+						std::destroy_n(oldEnd, count - tail);
+						throw;
+					}
+					m_size = required;
+					std::copy(first, mid, pos);
+				}
+			}
+		}
+
+		void assign(size_t count, const T& val) {
+			if (isInside(&val)) {
+				T copy(val);
+				assign(count, copy);
+				return;
+			}
+
+			clear();
+			if (count > m_capacity) {
+				replaceBuffer(allocate(count), count);
+			}
+			std::uninitialized_fill_n(m_arr, count, val);
+			m_size = count;
+		}
+
+		void resize(size_t count) {
+			if (count <= m_size) {
+				std::destroy_n(m_arr + count, m_size - count);
+				m_size = count;
+				return;
+			}
+
+			if (count > m_capacity) reserve(growthFor(count));
+			std::uninitialized_value_construct_n(m_arr + m_size, count - m_size);
+			m_size = count;
+		}
+
+		void resize(size_t count, const T& val) {
+			if (count <= m_size) {
+				std::destroy_n(m_arr + count, m_size - count);
+				m_size = count;
+				return;
+			}
+			if (count > m_capacity && isInside(&val)) {
+				T copy(val);
+				resize(count, copy);
+				return;
+			}
+
+			if (count > m_capacity) reserve(growthFor(count));
+			std::uninitialized_fill_n(m_arr + m_size, count - m_size, val);
+			m_size = count;
+		}
+
+		// Reallocates to exactly size() elements, or frees the buffer when empty
+		void shrink_to_fit() {
+			if (m_size == m_capacity) return;
+
+			T* tempArr = allocate(m_size);
+			try {
+				relocate_n(m_arr, m_size, tempArr);
+			}
+			catch (...) {
+				deallocate(tempArr, m_size);
+				throw;
+			}
+
+			replaceBuffer(tempArr, m_size);
 		}
 
 
 		/********************** Utility **********************/
 
+		// Searches go through the SIMD kernels in Simd.h for arithmetic T
+		// and through plain loops otherwise
 		static constexpr size_t npos = static_cast<size_t>(-1);
 		size_t find(const T& val) const {
-			for (size_t i = 0; i < m_size; ++i) if (m_arr[i] == val) return i;
-			return npos;
+			if constexpr (simd::is_vectorizable_v<T>) {
+				return simd::find(m_arr, m_size, val);
+			}
+			else {
+				for (size_t i = 0; i < m_size; ++i) if (m_arr[i] == val) return i;
+				return npos;
+			}
+		}
+
+		// Vectorized for simd::equal_to / not_equal_to / less_than / greater_than
+		template <typename Pred>
+		size_t find_if(Pred pred) const {
+			return simd::find_if(m_arr, m_size, pred);
+		}
+
+		size_t count(const T& val) const {
+			if constexpr (simd::is_vectorizable_v<T>) {
+				return simd::count(m_arr, m_size, val);
+			}
+			else {
+				size_t total = 0;
+				for (size_t i = 0; i < m_size; ++i) if (m_arr[i] == val) total++;
+				return total;
+			}
+		}
+
+		bool contains(const T& val) const {
+			return find(val) != npos;
+		}
+
+		// Index of the first smallest / largest element, npos when empty
+		size_t min_element() const {
+			return simd::min_element(m_arr, m_size);
+		}
+		size_t max_element() const {
+			return simd::max_element(m_arr, m_size);
 		}
 
 		void swap(Vector& other) noexcept {
 			std::swap(m_size, other.m_size);
 			std::swap(m_capacity, other.m_capacity);
 			std::swap(m_arr, other.m_arr);
+			std::swap(m_alloc, other.m_alloc);
 		}
 
 	private:
+		/********************** Storage **********************/
+
+		using alloc_traits = std::allocator_traits<Alloc>;
+
+		template <typename A, typename = void>
+		struct has_expand : std::false_type {};
+		template <typename A>
+		struct has_expand<A, std::void_t<decltype(std::declval<A&>().expand(std::declval<T*>(), size_t{}, size_t{}))>>
+			: std::true_type {};
+
+		template <typename G, typename = void>
+		struct has_on_reallocate : std::false_type {};
+		template <typename G>
+		struct has_on_reallocate<G, std::void_t<decltype(G::onReallocate(size_t{}, size_t{}, size_t{}))>>
+			: std::true_type {};
+
+		template <typename G, typename = void>
+		struct has_on_expand : std::false_type {};
+		template <typename G>
+		struct has_on_expand<G, std::void_t<decltype(G::onExpand(size_t{}, size_t{}))>>
+			: std::true_type {};
+
+		// Raw, uninitialized storage: slots [m_size, m_capacity) hold no objects
+		T* allocate(size_t count) {
+			if (count == 0) return nullptr;
+			return alloc_traits::allocate(m_alloc, count);
+		}
+
+		void deallocate(T* ptr, size_t count) noexcept {
+			if (ptr) alloc_traits::deallocate(m_alloc, ptr, count);
+		}
+
+		// Grows the current block without moving it, if the allocator can
+		bool tryExpand(size_t newCapacity) noexcept {
+			if constexpr (has_expand<Alloc>::value) {
+				if (m_arr && m_alloc.expand(m_arr, m_capacity, newCapacity)) {
+					if constexpr (has_on_expand<Growth>::value) {
+						Growth::onExpand(m_capacity, newCapacity);
+					}
+					m_capacity = newCapacity;
+					return true;
+				}
+			}
+			else {
+				(void)newCapacity;
+			}
+			return false;
+		}
+
+		// Frees the current buffer, whose m_size elements were already
+		// relocated into newArr, and switches over to newArr
+		void replaceBuffer(T* newArr, size_t newCapacity) noexcept {
+			size_t oldCapacity = m_capacity;
+			deallocate(m_arr, m_capacity);
+			m_arr = newArr;
+			m_capacity = newCapacity;
+
+			if constexpr (has_on_reallocate<Growth>::value) {
+				Growth::onReallocate(oldCapacity, newCapacity, m_size * sizeof(T));
+			}
+		}
+
+		size_t nextCapacity() const {
+			return growthFor(m_capacity + 1);
+		}
+
+		size_t growthFor(size_t required) const {
+			return Growth::next(m_capacity, required, sizeof(T));
+		}
+
+		bool isInside(const T* ptr) const noexcept {
+			return !std::less<const T*>()(ptr, m_arr) && std::less<const T*>()(ptr, m_arr + m_size);
+		}
+
+		// Moves [0, index) to dst and [index, size) to dst + index + gap with
+		// the same all-or-nothing guarantee as relocate_n
+		void relocateAround(T* dst, size_t index, size_t gap) {
+			if constexpr (is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+				relocate_n(m_arr, index, dst);
+				relocate_n(m_arr + index, m_size - index, dst + index + gap);
+			}
+			else {
+				std::uninitialized_copy_n(m_arr, index, dst);
+				try {
+					std::uninitialized_copy_n(m_arr + index, m_size - index, dst + index + gap);
+				}
+				catch (...) {
+					std::destroy_n(dst, index);
+					throw;
+				}
+				std::destroy_n(m_arr, m_size);
+			}
+		}
+
 		size_t m_size;
 		size_t m_capacity;
 		T* m_arr;
+		Alloc m_alloc;
 	};
 }
\ No newline at end of file
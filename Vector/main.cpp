@@ -1,10 +1,222 @@
 #include <iostream>
 #include <cassert>
+#include <string>
+#include <memory>
+#include <chrono>
+#include <list>
+#include <sstream>
+#include <iterator>
+#include <random>
+#include <cstdint>
+#include <algorithm>
+#include <numeric>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstdio>
 
 #include "Vector.h"
+#include "Allocator.h"
+#include "SmallVector.h"
+#include "SegmentedVector.h"
+#include "ConcurrentVector.h"
+#include "MappedVector.h"
 
 using namespace pSTL;
 
+// Counts live objects and default constructions to check that unused capacity holds no objects
+struct Tracked {
+    static int alive;
+    static int defaults;
+    int value;
+
+    Tracked() : value(0) { ++alive; ++defaults; }
+    Tracked(int v) : value(v) { ++alive; }
+    Tracked(const Tracked& o) : value(o.value) { ++alive; }
+    Tracked(Tracked&& o) noexcept : value(o.value) { ++alive; }
+    Tracked& operator=(const Tracked&) = default;
+    Tracked& operator=(Tracked&&) = default;
+    ~Tracked() { --alive; }
+};
+int Tracked::alive = 0;
+int Tracked::defaults = 0;
+
+// Owning handle that is not trivially copyable but is safe to move with memcpy
+struct Handle {
+    std::unique_ptr<int> ptr;
+
+    Handle(int v) : ptr(new int(v)) {}
+    Handle(const Handle& o) : ptr(new int(*o.ptr)) {}
+    Handle(Handle&&) noexcept = default;
+    Handle& operator=(const Handle& o) { ptr.reset(new int(*o.ptr)); return *this; }
+    Handle& operator=(Handle&&) noexcept = default;
+};
+template <> struct pSTL::is_trivially_relocatable<Handle> : std::true_type {};
+
+// Same layout as int, but user-provided copy/move forces the element-wise path
+struct SlowInt {
+    int v;
+
+    SlowInt(int x) : v(x) {}
+    SlowInt(const SlowInt& o) : v(o.v) {}
+    SlowInt(SlowInt&& o) noexcept : v(o.v) {}
+    SlowInt& operator=(const SlowInt& o) { v = o.v; return *this; }
+    SlowInt& operator=(SlowInt&& o) noexcept { v = o.v; return *this; }
+    ~SlowInt() {}
+};
+
+// std::allocator that counts allocate() calls
+template <typename T>
+struct CountingAllocator : std::allocator<T> {
+    static inline int allocations = 0;
+
+    template <typename U> struct rebind { using other = CountingAllocator<U>; };
+
+    CountingAllocator() = default;
+    template <typename U> CountingAllocator(const CountingAllocator<U>&) {}
+
+    T* allocate(std::size_t n) {
+        ++allocations;
+        return std::allocator<T>::allocate(n);
+    }
+};
+
+// SIMD kernels must agree with the scalar loops for every size, type and predicate
+template <typename T>
+void checkKernels(unsigned seed) {
+    std::mt19937 rng(seed);
+    const size_t sizes[] = { 0, 1, 3, 7, 8, 15, 16, 17, 31, 32, 33, 63, 64, 65, 100, 1000 };
+    for (size_t n : sizes) {
+        Vector<T> v;
+        for (size_t i = 0; i < n; i++) {
+            int r = static_cast<int>(rng() % 16);
+            v.push_back(static_cast<T>(std::is_signed_v<T> ? r - 8 : r));
+        }
+
+        for (int probe = -9; probe <= 16; probe++) {
+            if (!std::is_signed_v<T> && probe < 0) continue;
+            T value = static_cast<T>(probe);
+
+            assert(v.find(value) == simd::scalar::find_if(v.begin(), n, simd::equal_to<T>{ value }));
+            assert(v.count(value) == simd::scalar::count_if(v.begin(), n, simd::equal_to<T>{ value }));
+            assert(v.find_if(simd::not_equal_to<T>{ value }) == simd::scalar::find_if(v.begin(), n, simd::not_equal_to<T>{ value }));
+            assert(v.find_if(simd::less_than<T>{ value }) == simd::scalar::find_if(v.begin(), n, simd::less_than<T>{ value }));
+            assert(v.find_if(simd::greater_than<T>{ value }) == simd::scalar::find_if(v.begin(), n, simd::greater_than<T>{ value }));
+            assert(simd::count_if(v.begin(), n, simd::less_than<T>{ value }) == simd::scalar::count_if(v.begin(), n, simd::less_than<T>{ value }));
+        }
+        assert(v.min_element() == (simd::scalar::extreme<T, false>(v.begin(), n)));
+        assert(v.max_element() == (simd::scalar::extreme<T, true>(v.begin(), n)));
+    }
+}
+
+// Repeated scans of a vector of 32-bit ids
+void benchFind() {
+    const uint32_t count = 1 << 16;
+    const int rounds = 2000;
+    Vector<uint32_t> ids;
+    for (uint32_t i = 0; i < count; i++) ids.push_back(i * 7);
+
+    size_t sink = 0;
+    auto startTime = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < rounds; r++) sink += ids.find(static_cast<uint32_t>((count - 1 - r) * 7));
+    auto midTime = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < rounds; r++) sink += simd::scalar::find_if(ids.begin(), ids.size(), simd::equal_to<uint32_t>{ static_cast<uint32_t>((count - 1 - r) * 7) });
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double, std::milli> vectorized = midTime - startTime;
+    std::chrono::duration<double, std::milli> scalar = endTime - midTime;
+    std::cout << "find over " << count << " uint32 ids x" << rounds << ": simd " << vectorized.count()
+        << " ms (avx2 " << (simd::has_avx2() ? "on" : "off") << "), scalar " << scalar.count() << " ms [" << sink % 10 << "]\n";
+}
+
+// Append-heavy workload: contiguous Vector vs chunked SegmentedVector
+template <typename Container>
+void benchAppend(const char* label) {
+    const size_t count = 20000000;
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    Container c;
+    for (size_t i = 0; i < count; i++) c.push_back(static_cast<uint64_t>(i));
+    auto midTime = std::chrono::high_resolution_clock::now();
+
+    uint64_t sum = 0;
+    for (uint64_t v : c) sum += v;
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double, std::milli> append = midTime - startTime;
+    std::chrono::duration<double, std::milli> scan = endTime - midTime;
+    std::cout << label << ": push_back x" << count << " " << append.count() << " ms, range-for scan "
+        << scan.count() << " ms [" << sum % 10 << "]\n";
+}
+
+// Multi-producer ingestion: lock-free ConcurrentVector vs Vector behind a mutex
+void benchConcurrentAppend() {
+    const size_t total = 8000000;
+    const unsigned threadCounts[] = { 1, 2, 4, 8 };
+
+    for (unsigned threads : threadCounts) {
+        size_t perThread = total / threads;
+
+        ConcurrentVector<uint64_t> lockFree;
+        auto startTime = std::chrono::high_resolution_clock::now();
+        {
+            std::vector<std::thread> workers;
+            for (unsigned t = 0; t < threads; t++) {
+                workers.emplace_back([&lockFree, perThread, t] {
+                    for (size_t i = 0; i < perThread; i++) lockFree.push_back(t * perThread + i);
+                });
+            }
+            for (auto& w : workers) w.join();
+        }
+        auto midTime = std::chrono::high_resolution_clock::now();
+
+        Vector<uint64_t> locked;
+        std::mutex lock;
+        {
+            std::vector<std::thread> workers;
+            for (unsigned t = 0; t < threads; t++) {
+                workers.emplace_back([&locked, &lock, perThread, t] {
+                    for (size_t i = 0; i < perThread; i++) {
+                        std::lock_guard<std::mutex> guard(lock);
+                        locked.push_back(t * perThread + i);
+                    }
+                });
+            }
+            for (auto& w : workers) w.join();
+        }
+        auto endTime = std::chrono::high_resolution_clock::now();
+
+        std::chrono::duration<double> lockFreeTime = midTime - startTime;
+        std::chrono::duration<double> lockedTime = endTime - midTime;
+        std::cout << threads << " threads, " << total << " appends: ConcurrentVector "
+            << total / lockFreeTime.count() / 1e6 << " M/s, mutex + Vector "
+            << total / lockedTime.count() / 1e6 << " M/s\n";
+    }
+}
+
+// Growth of a 10M element buffer plus repeated front insert/erase (each shifts the whole tail)
+template <typename T>
+void benchRelocation(const char* label) {
+    const size_t count = 10000000;
+    const int shifts = 20;
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    Vector<T> v;
+    for (size_t i = 0; i < count; i++) v.push_back(T(static_cast<int>(i)));
+    auto growTime = std::chrono::high_resolution_clock::now();
+
+    for (int i = 0; i < shifts; i++) {
+        v.insert_at(0, T(i));
+        v.erase_at(0);
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<double, std::milli> grow = growTime - startTime;
+    std::chrono::duration<double, std::milli> shift = endTime - growTime;
+    std::cout << label << ": push_back x" << count << " " << grow.count() << " ms, "
+        << shifts << "x insert_at/erase_at(0) " << shift.count() << " ms\n";
+}
+
 int main() {
     Vector<int> a;
     assert(a.size() == 0);
@@ -52,6 +264,489 @@ int main() {
     for (int v : a) sum += v;
     assert(sum == (1 + 99 + 2));
 
+    // growth must not default-construct spare capacity
+    {
+        Vector<Tracked> t;
+        for (int i = 0; i < 100; i++) t.emplace_back(i);
+        assert(t.size() == 100);
+        assert(Tracked::defaults == 0);
+        assert(Tracked::alive == 100);
+        assert(t[42].value == 42);
+
+        t.reserve(1000);
+        assert(Tracked::alive == 100);
+
+        t.insert_at(0, t[99]);
+        assert(t.size() == 101 && t[0].value == 99 && t[1].value == 0);
+        assert(Tracked::alive == 101);
+
+        t.pop_back();
+        assert(Tracked::alive == 100);
+
+        t.clear();
+        assert(t.empty() && Tracked::alive == 0);
+        assert(t.capacity() >= 1000);
+    }
+    assert(Tracked::alive == 0);
+
+    // emplace_back with non-trivial types, including self-referencing arguments
+    {
+        Vector<std::string> s;
+        s.emplace_back(3, 'x');
+        s.push_back("hello");
+        for (int i = 0; i < 20; i++) s.push_back(s[0]);
+        assert(s.size() == 22);
+        assert(s[0] == "xxx" && s[1] == "hello" && s[21] == "xxx");
+
+        Vector<std::string> copy = s;
+        assert(copy.size() == 22 && copy[1] == "hello");
+
+        Vector<std::string> filled(4, "abc");
+        assert(filled.size() == 4 && filled[3] == "abc");
+    }
+
+    // erase_at shifts the tail down on both the memmove and element-wise paths
+    {
+        Vector<int> e;
+        for (int i = 0; i < 10; i++) e.push_back(i);
+        e.erase_at(0);
+        e.erase_at(4);
+        e.erase_at(e.size() - 1);
+        assert(e.size() == 7);
+        assert(e[0] == 1 && e[3] == 4 && e[4] == 6 && e.back() == 8);
+
+        Vector<std::string> es;
+        for (int i = 0; i < 5; i++) es.push_back(std::to_string(i));
+        es.erase_at(1);
+        assert(es.size() == 4 && es[1] == "2" && es.back() == "4");
+
+        bool eraseThrew = false;
+        try { es.erase_at(4); }
+        catch (const std::out_of_range&) { eraseThrew = true; }
+        assert(eraseThrew);
+    }
+
+    // user-specialized relocatable type goes through memcpy/memmove
+    {
+        static_assert(is_trivially_relocatable_v<int>, "trivially copyable types are relocatable");
+        static_assert(!is_trivially_relocatable_v<std::string>, "not relocatable by default");
+        static_assert(is_trivially_relocatable_v<Handle>, "opted in by specialization");
+
+        Vector<Handle> h;
+        for (int i = 0; i < 50; i++) h.emplace_back(i);
+        h.insert_at(10, Handle(-1));
+        h.erase_at(0);
+        assert(h.size() == 50);
+        assert(*h[0].ptr == 1 && *h[9].ptr == -1 && *h[10].ptr == 10 && *h.back().ptr == 49);
+    }
+
+    // arena-backed vectors grow in place while they own the arena tail
+    {
+        Arena arena(4096);
+        Vector<int, ArenaAllocator<int>> v{ ArenaAllocator<int>(arena) };
+        v.reserve(4);
+        const int* first = v.begin();
+        for (int i = 0; i < 500; i++) v.push_back(i);
+        assert(v.begin() == first && "growth should expand the last arena block in place");
+        assert(v.size() == 500 && v[499] == 499);
+
+        Vector<std::string, ArenaAllocator<std::string>> names{ ArenaAllocator<std::string>(arena) };
+        for (int i = 0; i < 100; i++) names.emplace_back(std::to_string(i));
+        v.push_back(500); // v is no longer the last block and has to move
+        assert(v.size() == 501 && v[0] == 0 && v[500] == 500);
+        assert(names[99] == "99");
+        assert(arena.bytes_used() > 0);
+
+        Vector<int, ArenaAllocator<int>> copy = v;
+        assert(copy.get_allocator() == v.get_allocator());
+        assert(copy.size() == 501 && copy[250] == 250);
+    }
+
+    // huge page allocator, crossing the threshold from heap to mapped pages
+    {
+        Vector<size_t, HugePageAllocator<size_t>> big;
+        const size_t count = 3 * HugePageAllocator<size_t>::HugePageSize / sizeof(size_t);
+        for (size_t i = 0; i < count; i++) big.push_back(i);
+        assert(big.size() == count);
+        assert(big[0] == 0 && big[count / 2] == count / 2 && big.back() == count - 1);
+
+        big.reserve(big.capacity() + 1);
+        assert(big.back() == count - 1);
+    }
+
+    // SmallVector stays inline up to N and spills to the heap after that
+    {
+        SmallVector<int, 4> sv;
+        assert(sv.is_inline() && sv.capacity() == 4);
+        for (int i = 0; i < 4; i++) sv.push_back(i);
+        assert(sv.is_inline());
+        sv.push_back(4);
+        assert(!sv.is_inline() && sv.size() == 5);
+        assert(sv[0] == 0 && sv[4] == 4);
+
+        sv.insert_at(2, 42);
+        sv.erase_at(0);
+        assert(sv.size() == 5 && sv[0] == 1 && sv[1] == 42 && sv.back() == 4);
+        assert(sv.find(42) == 1 && sv.find(7) == static_cast<std::size_t>(-1));
+
+        sv.pop_back();
+        assert(sv.back() == 3);
+
+        bool svThrew = false;
+        try { (void)sv.at(10); }
+        catch (const std::out_of_range&) { svThrew = true; }
+        assert(svThrew);
+    }
+
+    // moves and swaps across inline and heap states
+    {
+        SmallVector<std::string, 2> small;
+        small.push_back("a");
+        SmallVector<std::string, 2> large;
+        for (int i = 0; i < 5; i++) large.push_back(std::to_string(i));
+
+        small.swap(large);
+        assert(small.size() == 5 && !small.is_inline() && small[4] == "4");
+        assert(large.size() == 1 && large.is_inline() && large[0] == "a");
+
+        SmallVector<std::string, 2> movedHeap(std::move(small));
+        assert(movedHeap.size() == 5 && small.empty() && small.is_inline());
+
+        SmallVector<std::string, 2> movedInline(std::move(large));
+        assert(movedInline.is_inline() && movedInline[0] == "a" && large.empty());
+
+        SmallVector<std::string, 2> other;
+        other.push_back("x");
+        other.push_back("y");
+        other.swap(movedInline);
+        assert(other.size() == 1 && other[0] == "a");
+        assert(movedInline.size() == 2 && movedInline[1] == "y");
+
+        movedInline = movedHeap;
+        assert(movedInline.size() == 5 && movedInline[2] == "2" && movedHeap[2] == "2");
+
+        movedHeap = std::move(other);
+        assert(movedHeap.size() == 1 && movedHeap.is_inline() && movedHeap[0] == "a");
+
+        int total = 0;
+        for (const std::string& str : movedInline) total += static_cast<int>(str.size());
+        assert(total == 5);
+    }
+
+    {
+        SmallVector<Tracked, 3> tracked;
+        for (int i = 0; i < 10; i++) tracked.emplace_back(i);
+        assert(Tracked::alive == 10 && Tracked::defaults == 0);
+        tracked.clear();
+        assert(Tracked::alive == 0);
+    }
+
+    // bulk append from a sized range is a single exact allocation
+    {
+        std::list<int> source;
+        for (int i = 0; i < 1000000; i++) source.push_back(i);
+
+        CountingAllocator<int>::allocations = 0;
+        Vector<int, CountingAllocator<int>> built;
+        built.append(source.begin(), source.end());
+        assert(CountingAllocator<int>::allocations == 1);
+        assert(built.size() == 1000000 && built.capacity() == 1000000);
+        assert(built[0] == 0 && built[999999] == 999999);
+
+        Vector<int> fromRange(source.begin(), source.end());
+        assert(fromRange.size() == 1000000 && fromRange[123456] == 123456);
+    }
+
+    // range insert in the middle, with and without growth, and from an aliasing range
+    {
+        Vector<int> v;
+        for (int i = 0; i < 6; i++) v.push_back(i);
+        v.reserve(64);
+        int extra[] = { 100, 101, 102 };
+        v.insert(2, extra, extra + 3);
+        assert(v.size() == 9);
+        assert(v[1] == 1 && v[2] == 100 && v[4] == 102 && v[5] == 2 && v[8] == 5);
+
+        v.insert(0, v.begin() + 2, v.begin() + 5);
+        assert(v.size() == 12 && v[0] == 100 && v[2] == 102 && v[3] == 0 && v[5] == 100);
+
+        v.append(v.begin(), v.end());
+        assert(v.size() == 24 && v[12] == 100 && v[23] == 5);
+
+        Vector<std::string> s;
+        for (int i = 0; i < 5; i++) s.push_back(std::to_string(i));
+        std::string few[] = { "a", "b" };
+        s.reserve(20);
+        s.insert(1, few, few + 2);     // fewer new elements than tail
+        assert(s.size() == 7 && s[0] == "0" && s[1] == "a" && s[2] == "b" && s[3] == "1" && s[6] == "4");
+        std::string many[] = { "w", "x", "y", "z" };
+        s.insert(5, many, many + 4);   // more new elements than tail
+        assert(s.size() == 11 && s[4] == "2" && s[5] == "w" && s[8] == "z" && s[9] == "3" && s[10] == "4");
+        s.insert(0, s.begin() + 5, s.begin() + 9);
+        assert(s.size() == 15 && s[0] == "w" && s[3] == "z" && s[4] == "0");
+
+        std::istringstream input("7 8 9");
+        Vector<int> streamed;
+        streamed.push_back(1);
+        streamed.push_back(2);
+        streamed.insert(1, std::istream_iterator<int>(input), std::istream_iterator<int>());
+        assert(streamed.size() == 5 && streamed[1] == 7 && streamed[3] == 9 && streamed[4] == 2);
+    }
+
+    // assign / resize / shrink_to_fit
+    {
+        Vector<std::string> r;
+        r.assign(5, "x");
+        assert(r.size() == 5 && r[4] == "x");
+        r.assign(2, r[0]);
+        assert(r.size() == 2 && r[1] == "x");
+
+        r.resize(6);
+        assert(r.size() == 6 && r[5].empty());
+        r.resize(10, r[0]);
+        assert(r.size() == 10 && r[9] == "x");
+        r.resize(3);
+        assert(r.size() == 3 && r[0] == "x");
+
+        r.shrink_to_fit();
+        assert(r.capacity() == 3 && r[2].empty());
+        r.clear();
+        r.shrink_to_fit();
+        assert(r.capacity() == 0 && r.begin() == nullptr);
+
+        Vector<Tracked> t;
+        t.resize(10);
+        assert(Tracked::alive == 10 && Tracked::defaults == 10);
+        t.resize(4);
+        assert(Tracked::alive == 4);
+    }
+    assert(Tracked::alive == 0);
+    Tracked::defaults = 0;
+
+    // vectorized search kernels
+    {
+        checkKernels<int8_t>(1);
+        checkKernels<uint8_t>(2);
+        checkKernels<int16_t>(3);
+        checkKernels<uint16_t>(4);
+        checkKernels<int32_t>(5);
+        checkKernels<uint32_t>(6);
+        checkKernels<int64_t>(7);
+        checkKernels<uint64_t>(8);
+        checkKernels<float>(9);
+        checkKernels<double>(10);
+        checkKernels<char>(11);
+        checkKernels<long long>(12);
+
+        Vector<uint32_t> ids;
+        for (uint32_t i = 0; i < 1000; i++) ids.push_back(i);
+        assert(ids.contains(999) && !ids.contains(1000));
+        assert(ids.find_if([](uint32_t x) { return x * x > 1000; }) == 32);
+
+        Vector<std::string> words;
+        words.push_back("a");
+        words.push_back("b");
+        words.push_back("a");
+        assert(words.count("a") == 2 && words.contains("b") && !words.contains("c"));
+        assert(words.min_element() == 0 && words.max_element() == 1);
+    }
+
+    // growth policies and growth instrumentation
+    {
+        assert(GrowOneAndHalf::next(0, 1, 4) == 1 && GrowOneAndHalf::next(10, 11, 4) == 16);
+        assert(GrowDouble::next(0, 1, 4) == 1 && GrowDouble::next(8, 9, 4) == 16 && GrowDouble::next(8, 100, 4) == 100);
+        assert(GrowFixedChunk<64>::next(0, 1, 4) == 64 && GrowFixedChunk<64>::next(64, 65, 4) == 128);
+        assert(GrowFixedChunk<64>::next(64, 200, 4) == 256);
+        assert(GrowPowerOfTwo::sizeClass(100) == 112 && GrowPowerOfTwo::sizeClass(129) == 160 && GrowPowerOfTwo::sizeClass(4096) == 4096);
+        assert(GrowPowerOfTwo::next(4, 5, 24) == 8 && GrowPowerOfTwo::next(8, 9, 36) == 17); // 576 bytes -> 640 byte class
+
+        struct PolicyTestTag;
+        using Tracked2x = InstrumentedGrowth<GrowDouble, PolicyTestTag>;
+        Tracked2x::stats().reset();
+        {
+            Vector<int, std::allocator<int>, Tracked2x> v;
+            for (int i = 0; i < 1000; i++) v.push_back(i);
+            assert(v.capacity() == 1024);
+            assert(Tracked2x::stats().reallocations == 11);           // 1, 2, 4, ..., 1024
+            assert(Tracked2x::stats().peakCapacity == 1024);
+            assert(Tracked2x::stats().bytesRelocated == (1023 - 0) * sizeof(int)); // 1 + 2 + ... + 512
+
+            v.shrink_to_fit();
+            assert(Tracked2x::stats().reallocations == 12 && Tracked2x::stats().peakCapacity == 1024);
+        }
+
+        struct ArenaTag;
+        using TrackedArena = InstrumentedGrowth<GrowOneAndHalf, ArenaTag>;
+        Arena arena;
+        Vector<int, ArenaAllocator<int>, TrackedArena> a{ ArenaAllocator<int>(arena) };
+        a.reserve(8);
+        for (int i = 0; i < 100; i++) a.push_back(i);
+        assert(TrackedArena::stats().reallocations == 1 && TrackedArena::stats().expansions > 0);
+        assert(TrackedArena::stats().bytesRelocated == 0);
+    }
+
+    // SegmentedVector never relocates elements
+    {
+        SegmentedVector<std::string, 4> seg;
+        seg.push_back("first");
+        const std::string* firstAddr = &seg[0];
+        for (int i = 1; i < 100; i++) seg.push_back(std::to_string(i));
+        assert(&seg[0] == firstAddr && seg[0] == "first");
+        assert(seg.size() == 100 && seg.chunk_count() == 7 && seg.capacity() == 112);
+        assert(seg.at(99) == "99" && seg.back() == "99" && seg.front() == "first");
+        assert(seg.find("42") == 42 && seg.find("nope") == static_cast<std::size_t>(-1));
+
+        for (int i = 0; i < 10; i++) seg.push_back(seg[0]);
+        assert(seg.size() == 110 && seg[109] == "first");
+
+        seg.pop_back();
+        assert(seg.size() == 109);
+
+        SegmentedVector<std::string, 4> copy = seg;
+        assert(copy.size() == 109 && copy[50] == "50" && &copy[0] != &seg[0]);
+
+        SegmentedVector<std::string, 4> moved = std::move(copy);
+        assert(moved.size() == 109 && copy.empty());
+
+        seg.clear();
+        assert(seg.empty() && seg.capacity() == 112);
+
+        SegmentedVector<int, 3> ints;
+        for (int i = 0; i < 50; i++) ints.push_back(49 - i);
+        assert(ints.find(0) == 49 && ints.find(49) == 0);
+        std::sort(ints.begin(), ints.end());
+        assert(ints[0] == 0 && ints[49] == 49);
+        assert(std::accumulate(ints.cbegin(), ints.cend(), 0) == 49 * 50 / 2);
+        assert(ints.end() - ints.begin() == 50);
+        SegmentedVector<int, 3>::const_iterator it = ints.begin();
+        assert(it[10] == 10 && *(it + 20) == 20);
+
+        int total = 0;
+        for (int v : ints) total += v;
+        assert(total == 49 * 50 / 2);
+
+        SegmentedVector<Tracked, 2> tracked(7);
+        assert(Tracked::alive == 7);
+    }
+    assert(Tracked::alive == 0);
+    Tracked::defaults = 0;
+
+    // ConcurrentVector: every producer's items land exactly once
+    {
+        ConcurrentVector<uint64_t, 4> cv;
+        const unsigned producers = 8;
+        const size_t perProducer = 20000;
+        std::atomic<bool> done{ false };
+        std::atomic<size_t> checked{ 0 };
+
+        std::thread reader([&] {
+            while (!done.load()) {
+                size_t n = cv.size();
+                for (size_t i = 0; i < n; i += 97) {
+                    if (cv.is_published(i)) {
+                        uint64_t v = cv[i];
+                        assert((v >> 32) < producers && (v & 0xFFFFFFFF) < perProducer);
+                        checked++;
+                    }
+                }
+            }
+        });
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < producers; t++) {
+            workers.emplace_back([&cv, t, perProducer] {
+                for (size_t i = 0; i < perProducer; i++) {
+                    size_t index = cv.push_back((static_cast<uint64_t>(t) << 32) | i);
+                    assert(cv[index] == ((static_cast<uint64_t>(t) << 32) | i));
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+        done = true;
+        reader.join();
+
+        assert(cv.size() == producers * perProducer);
+        std::vector<uint64_t> seen;
+        for (size_t i = 0; i < cv.size(); i++) {
+            assert(cv.is_published(i));
+            seen.push_back(cv[i]);
+        }
+        std::sort(seen.begin(), seen.end());
+        assert(std::adjacent_find(seen.begin(), seen.end()) == seen.end());
+        assert(seen.front() == 0 && seen.back() == ((static_cast<uint64_t>(producers - 1) << 32) | (perProducer - 1)));
+
+        size_t first = cv.grow_by(100, uint64_t(7));
+        assert(first == producers * perProducer && cv.size() == first + 100);
+        assert(cv.at(first) == 7 && cv.at(first + 99) == 7);
+        bool cvThrew = false;
+        try { (void)cv.at(first + 100); }
+        catch (const std::out_of_range&) { cvThrew = true; }
+        assert(cvThrew && !cv.is_published(first + 100));
+
+        ConcurrentVector<std::string> strings;
+        strings.emplace_back(3, 'z');
+        strings.grow_by(2, "s");
+        assert(strings.size() == 3 && strings[0] == "zzz" && strings[2] == "s");
+        strings.clear();
+        assert(strings.empty());
+    }
+
+    // MappedVector: contents survive close/reopen through the file
+    {
+        const std::string path = "pstl_mapped_vector.test";
+        std::remove(path.c_str());
+        {
+            MappedVector<uint64_t> mv(path);
+            assert(mv.is_open() && mv.empty() && mv.capacity() > 0);
+            for (uint64_t i = 0; i < 100000; i++) mv.push_back(i * 3);
+            assert(mv.size() == 100000 && mv.capacity() >= 100000);
+            assert(mv.front() == 0 && mv.back() == 99999 * 3);
+            mv.push_back(mv[5]);     // aliasing across growth
+            assert(mv.back() == 15);
+            mv.pop_back();
+            mv.insert_at(0, 42);
+            mv.erase_at(1);
+            assert(mv[0] == 42 && mv[1] == 3);
+            mv.sync();
+        }
+        {
+            MappedVector<uint64_t> mv(path);
+            assert(mv.size() == 100000 && mv[0] == 42 && mv[99999] == 99999 * 3);
+            assert(mv.find(300) == 100 && mv.find(1) == MappedVector<uint64_t>::npos);
+            uint64_t sum = 0;
+            for (uint64_t v : mv) sum += v;
+            assert(sum == 42 + 3 * (99999ull * 100000 / 2));
+
+            MappedVector<uint64_t> moved = std::move(mv);
+            assert(!mv.is_open() && moved.size() == 100000);
+            moved.clear();
+        }
+        {
+            MappedVector<uint64_t> mv(path);
+            assert(mv.empty() && mv.capacity() >= 100000);
+            bool mvThrew = false;
+            try { (void)mv.at(0); }
+            catch (const std::out_of_range&) { mvThrew = true; }
+            assert(mvThrew);
+        }
+        {
+            bool wrongType = false;
+            try { MappedVector<uint32_t> mv(path); }
+            catch (const std::runtime_error&) { wrongType = true; }
+            assert(wrongType);
+        }
+        std::remove(path.c_str());
+    }
+
+#ifdef PSTL_BENCHMARK
+    benchConcurrentAppend();
+    benchAppend<Vector<uint64_t>>("Vector<uint64_t>");
+    benchAppend<SegmentedVector<uint64_t, 12>>("SegmentedVector<uint64_t, 12>");
+    benchFind();
+    benchRelocation<int>("int (memcpy/memmove)");
+    benchRelocation<SlowInt>("SlowInt (element-wise)");
+#endif
+
     std::cout << "All runtime tests passed.\n";
     return 0;
 }
\ No newline at end of file